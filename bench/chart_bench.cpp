@@ -0,0 +1,121 @@
+#include "headless_display.hpp"
+#include "lvgl_chart.hpp"
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <vector>
+
+/*
+ * Feeds 10 kHz of synthetic signal into a chart and reports how much CPU time
+ * one second of signal costs, including the redraws triggered by the chart.
+ * The LVGL tick is advanced manually, so every run renders the same frames.
+ */
+
+static constexpr int sample_rate = 10000;
+static constexpr int signal_seconds = 10;
+static constexpr int tick_ms = 5;
+static constexpr int samples_per_tick = sample_rate * tick_ms / 1000;
+
+static std::vector<int32_t> make_signal() {
+    std::vector<int32_t> sig(sample_rate * signal_seconds);
+    for (size_t i = 0; i < sig.size(); i++) {
+        sig[i] = int32_t(500 + 400 * std::sin(i * 0.0031) +
+                         50 * std::sin(i * 0.173));
+    }
+    return sig;
+}
+
+template <typename Push>
+static void run(const char *name, const std::vector<int32_t> &sig,
+                bench::headless_display_driver<800, 480> &disp, Push push) {
+    disp.flushed_pixels = 0;
+    disp.flush_count = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t ofs = 0; ofs + samples_per_tick <= sig.size();
+         ofs += samples_per_tick) {
+        push(std::span<const int32_t>{&sig[ofs], samples_per_tick});
+        lv_tick_inc(tick_ms);
+        lv_timer_handler();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start);
+
+    const double per_second = elapsed.count() / signal_seconds;
+    printf("%-28s %8.2f ms CPU per signal second (%5.1f%% load), "
+           "%6llu flushes, %9.1f kpx flushed/s\n",
+           name, per_second, per_second / 10.0,
+           static_cast<unsigned long long>(disp.flush_count),
+           disp.flushed_pixels / 1000.0 / signal_seconds);
+}
+
+int main() {
+    lvgl::init();
+
+    static lvgl::drivers::static_buffer<800, 48> buffer;
+    bench::headless_display_driver<800, 480> disp{buffer};
+
+    lvgl::screen scr;
+    lvgl::screen::load(scr);
+
+    const auto sig = make_signal();
+
+    {
+        lvgl::stream_chart<4096> chart{&scr, lv_palette_main(LV_PALETTE_BLUE),
+                                       lvgl::chart::update_mode::circular};
+        chart.set_size(760, 440);
+        chart.align(lvgl::alignment::center);
+        chart.set_range(lvgl::chart::axis::primary_y, 0, 1000);
+        run("stream_chart (circular)", sig, disp,
+            [&](std::span<const int32_t> s) { chart.push(s); });
+    }
+
+    {
+        lvgl::stream_chart<4096> chart{&scr, lv_palette_main(LV_PALETTE_BLUE),
+                                       lvgl::chart::update_mode::shift};
+        chart.set_size(760, 440);
+        chart.align(lvgl::alignment::center);
+        chart.set_range(lvgl::chart::axis::primary_y, 0, 1000);
+        run("stream_chart (shift)", sig, disp,
+            [&](std::span<const int32_t> s) { chart.push(s); });
+    }
+
+    {
+        // 4 s of signal, one column per pixel of the content width
+        lvgl::decimated_chart<4 * sample_rate> chart{
+            &scr, lv_palette_main(LV_PALETTE_BLUE)};
+        chart.set_size(760, 440);
+        chart.align(lvgl::alignment::center);
+        chart.set_range(lvgl::chart::axis::primary_y, 0, 1000);
+        run("decimated_chart (min/max)", sig, disp,
+            [&](std::span<const int32_t> s) { chart.push(s); });
+    }
+
+    {
+        lvgl::decimated_chart<4 * sample_rate, lvgl::decimation::lttb> chart{
+            &scr, lv_palette_main(LV_PALETTE_BLUE)};
+        chart.set_size(760, 440);
+        chart.align(lvgl::alignment::center);
+        chart.set_range(lvgl::chart::axis::primary_y, 0, 1000);
+        run("decimated_chart (lttb)", sig, disp,
+            [&](std::span<const int32_t> s) { chart.push(s); });
+    }
+
+    {
+        lvgl::chart chart{&scr};
+        chart.set_size(760, 440);
+        chart.align(lvgl::alignment::center);
+        chart.set_type(lvgl::chart::type::line);
+        chart.set_point_count(4096);
+        chart.set_update_mode(lvgl::chart::update_mode::circular);
+        chart.set_range(lvgl::chart::axis::primary_y, 0, 1000);
+        auto ser = chart.add_series(lv_palette_main(LV_PALETTE_RED));
+        run("lv_chart_set_next_value", sig, disp,
+            [&](std::span<const int32_t> s) {
+                for (auto v : s)
+                    chart.set_next_value(ser, static_cast<lvgl::coord_t>(v));
+            });
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_display_driver.hpp"
+
+namespace bench {
+
+/**
+ * @brief Display driver without any output.
+ *
+ * Flushes are acknowledged immediately; only the number of flushed pixels is
+ * recorded so benchmarks can tell how much of the screen was redrawn.
+ */
+template <lv_coord_t Hor, lv_coord_t Ver>
+class headless_display_driver
+    : public lvgl::drivers::display_driver<headless_display_driver<Hor, Ver>> {
+
+  public:
+    static constexpr lv_coord_t hor_res = Hor;
+    static constexpr lv_coord_t ver_res = Ver;
+
+    uint64_t flushed_pixels = 0;
+    uint64_t flush_count = 0;
+
+    template <typename Buffer>
+    headless_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer)
+        : lvgl::drivers::display_driver<headless_display_driver<Hor, Ver>>{
+              buffer} {}
+
+    void flush_display(const lvgl::area_t &area, lvgl::color_t *color_p) {
+        (void)color_p;
+        flushed_pixels += uint64_t(area.get_width()) * area.get_height();
+        flush_count++;
+        this->flush_ready();
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,588 @@
+#include "demo_screens.hpp"
+#include "lvgl.hpp"
+#include "lvgl_display_driver.hpp"
+#include "lvgl_font.hpp"
+#include "lvgl_image.hpp"
+#include "lvgl_mem.hpp"
+#include "lvgl_replay.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+/*
+ * Frame times of the demo screens and a set of stress screens on a headless
+ * 800x600 display. The LVGL tick is advanced manually, so every run renders
+ * the same frames; the results are printed as JSON (to the file given as the
+ * first argument, or stdout) to be compared between releases.
+ *
+ * Static screens are invalidated before every frame, animated ones redraw
+ * whatever their animations touch. "render" is the time spent in
+ * lv_timer_handler() minus the time spent in the flush callback, which
+ * copies the flushed areas into a framebuffer like a display controller
+ * would. "mem_bytes" is what LVGL allocated for a scenario's screen,
+ * "mem_peak_bytes" the most it held at once while the scenario ran; the
+ * screen is deleted before the next scenario.
+ *
+ * The compressed_text screens draw the same text in a compressed font,
+ * decoding each glyph on every draw or once through lvgl::cached_font.
+ *
+ * The gallery scrolls through images that are decoded in the background
+ * while it moves; the queue of lvgl::ui_queue is drained as part of every
+ * frame.
+ *
+ * Last, a recorded user flow is replayed twice on the demo screen: the file
+ * in $LVGL_REPLAY (as saved by the simulator's $LVGL_RECORD), or a built-in
+ * flow of taps and key presses. Both runs must render bit-identical frames;
+ * the benchmark fails if they don't.
+ */
+
+static constexpr lv_coord_t hor_res = 800;
+static constexpr lv_coord_t ver_res = 600;
+static constexpr uint32_t tick_ms = 16;
+static constexpr int warmup_frames = 10;
+static constexpr int frames = 300;
+
+using bench_clock = std::chrono::steady_clock;
+
+class framebuffer_display_driver
+    : public lvgl::drivers::display_driver<framebuffer_display_driver> {
+
+    std::vector<lvgl::color_t> _fb =
+        std::vector<lvgl::color_t>(hor_res * ver_res);
+
+  public:
+    static constexpr lv_coord_t hor_res = ::hor_res;
+    static constexpr lv_coord_t ver_res = ::ver_res;
+
+    bench_clock::duration flush_time{};
+    uint64_t flush_count = 0;
+    uint64_t flushed_pixels = 0;
+
+    template <typename Buffer>
+    framebuffer_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer)
+        : display_driver{buffer} {}
+
+    void flush_display(const lvgl::area_t &area, lvgl::color_t *color_p) {
+        const auto start = bench_clock::now();
+        const auto w = area.get_width();
+        for (lv_coord_t y = area.y1; y <= area.y2; y++, color_p += w)
+            std::copy_n(color_p, w, &_fb[y * hor_res + area.x1]);
+        flush_time += bench_clock::now() - start;
+
+        flush_count++;
+        flushed_pixels += uint64_t(w) * area.get_height();
+        this->flush_ready();
+    }
+
+    /// FNV-1a hash of the framebuffer
+    uint64_t hash() const {
+        uint64_t h = 14695981039346656037ull;
+        auto p = reinterpret_cast<const uint8_t *>(_fb.data());
+        for (std::size_t i = 0; i < _fb.size() * sizeof(_fb[0]); i++)
+            h = (h ^ p[i]) * 1099511628211ull;
+        return h;
+    }
+};
+
+struct buttons_screen : lvgl::screen {
+    // declared before the labels, which are destroyed first
+    std::vector<lvgl::button> buttons;
+    std::vector<lvgl::label> labels;
+
+    buttons_screen() {
+        buttons = lvgl::make_many<lvgl::button>(
+            this, 300, [](lvgl::button &btn, std::size_t i) {
+                btn.set_pos(4 + i % 20 * 40, 4 + i / 20 * 40);
+                btn.set_size(36, 36);
+            });
+
+        labels.reserve(buttons.size());
+        for (std::size_t i = 0; i < buttons.size(); i++) {
+            auto &lbl = labels.emplace_back(buttons[i]);
+            lbl.set_text(std::to_string(i).c_str());
+            lbl.align(lvgl::alignment::center);
+        }
+    }
+};
+
+struct shadows_screen : lvgl::screen {
+    lvgl::style shadow;
+    std::vector<lvgl::button> buttons;
+
+    shadows_screen() {
+        shadow.set_property(LV_STYLE_SHADOW_WIDTH, 40);
+        shadow.set_property(LV_STYLE_SHADOW_SPREAD, 4);
+        shadow.set_property(LV_STYLE_SHADOW_OFS_Y, 8);
+        shadow.set_property(LV_STYLE_SHADOW_COLOR,
+                            lv_palette_main(LV_PALETTE_GREY));
+        shadow.set_property(LV_STYLE_SHADOW_OPA,
+                            static_cast<int>(LV_OPA_COVER));
+        shadow.set_property(LV_STYLE_RADIUS, 12);
+
+        for (int i = 0; i < 24; i++) {
+            auto &btn = buttons.emplace_back(this);
+            btn.set_pos(40 + i % 6 * 125, 40 + i / 6 * 140);
+            btn.set_size(90, 90);
+            btn.add_style(shadow);
+        }
+    }
+};
+
+struct gradients_screen : lvgl::screen {
+    std::array<lvgl::style, 2> gradient;
+    std::vector<lvgl::object> panels;
+
+    gradients_screen() {
+        const lv_palette_t palettes[] = {LV_PALETTE_RED, LV_PALETTE_BLUE};
+        for (int i = 0; i < 2; i++) {
+            gradient[i].set_bg_color(lv_palette_main(palettes[i]));
+            gradient[i].set_property(LV_STYLE_BG_GRAD_COLOR,
+                                     lv_palette_main(palettes[1 - i]));
+            gradient[i].set_property(
+                LV_STYLE_BG_GRAD_DIR,
+                static_cast<int>(i ? LV_GRAD_DIR_HOR : LV_GRAD_DIR_VER));
+        }
+
+        for (int i = 0; i < 16; i++) {
+            auto &panel = panels.emplace_back(this);
+            panel.set_pos(10 + i % 4 * 197, 10 + i / 4 * 147);
+            panel.set_size(187, 137);
+            panel.add_style(gradient[i % 2]);
+        }
+    }
+};
+
+struct labels_screen : lvgl::screen {
+    std::vector<std::unique_ptr<lvgl::label>> labels;
+
+    static constexpr const char *text =
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+        "eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim "
+        "ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut "
+        "aliquip ex ea commodo consequat. ";
+
+    labels_screen() {
+        for (int i = 0; i < 12; i++) {
+            auto lbl = std::make_unique<lvgl::label>(this);
+            lbl->set_pos(10, 10 + i * 48);
+            lbl->set_width(780);
+            // half of them wrap, the other half scroll continuously
+            lbl->set_long_mode(i % 2 ? lvgl::label::long_mode::scroll_circular
+                                     : lvgl::label::long_mode::wrap);
+            lbl->set_text(text);
+            labels.push_back(std::move(lbl));
+        }
+    }
+};
+
+/// wrapped text in a compressed font, decoded on every draw unless cached
+template <bool Cached> struct compressed_text_screen : lvgl::screen {
+    lvgl::style font;
+    std::vector<lvgl::label> labels;
+
+    compressed_text_screen() {
+        static lvgl::cached_font cached{lv_font_montserrat_28_compressed};
+        const lv_font_t *f =
+            Cached ? cached.get() : &lv_font_montserrat_28_compressed;
+        font.set_property(LV_STYLE_TEXT_FONT, f);
+
+        for (int i = 0; i < 5; i++) {
+            auto &lbl = labels.emplace_back(this);
+            lbl.set_pos(10, 10 + i * 118);
+            lbl.set_width(780);
+            lbl.add_style(font);
+            lbl.set_text(labels_screen::text);
+        }
+    }
+};
+
+struct meters_screen : lvgl::screen {
+    struct gauge {
+        lvgl::meter meter;
+        lvgl::meter::scale scale{meter.add_scale()};
+        lvgl::meter::indicator needle;
+        lvgl::animation anim;
+
+        gauge(lvgl::object_ref parent, int idx)
+            : meter{parent}, anim{[this](int32_t v) {
+                  meter.set_indicator_value(needle, v);
+              }} {
+            meter.set_pos(15 + idx % 4 * 195, 20 + idx / 4 * 290);
+            meter.set_size(180, 180);
+            meter.set_scale_ticks(scale);
+            meter.set_scale_major_ticks(scale);
+            needle = meter.add_indicator_needle(
+                scale, 4, lv_palette_main(LV_PALETTE_GREY), -10);
+
+            anim.set_range(0, 100);
+            anim.set_time(1000 + idx * 150);
+            anim.set_playback_time(1000);
+            anim.set_repeat(lvgl::animation::repeat_indef);
+            anim.start();
+        }
+    };
+
+    std::vector<std::unique_ptr<gauge>> gauges;
+
+    meters_screen() {
+        for (int i = 0; i < 8; i++)
+            gauges.push_back(std::make_unique<gauge>(this, i));
+    }
+};
+
+struct my_screen_animated : my_screen {
+    lvgl::animation anim{
+        [this](int32_t v) { meter.set_indicator_value(indic, v); }};
+
+    my_screen_animated() {
+        anim.set_range(0, 100);
+        anim.set_time(2000);
+        anim.set_playback_time(1000);
+        anim.set_repeat(lvgl::animation::repeat_indef);
+        anim.start();
+    }
+};
+
+/// generated gallery images, written in the native format once
+static std::string gallery_dir;
+static constexpr int gallery_images = 12;
+static constexpr lv_coord_t image_w = 240;
+static constexpr lv_coord_t image_h = 180;
+
+static bool write_gallery_images() {
+    namespace fmt = lvgl::image_format;
+
+    char dir[] = "/tmp/lvgl_bench_XXXXXX";
+    if (!mkdtemp(dir))
+        return false;
+    gallery_dir = dir;
+
+    std::vector<lv_color_t> px(image_w * image_h);
+    for (int n = 0; n < gallery_images; n++) {
+        for (lv_coord_t y = 0; y < image_h; y++)
+            for (lv_coord_t x = 0; x < image_w; x++)
+                px[y * image_w + x] = lv_color_make(
+                    uint8_t(x + n * 20), uint8_t(y + n * 40),
+                    uint8_t((x ^ y) + n * 10));
+
+        fmt::header h{};
+        memcpy(h.magic, fmt::magic, sizeof(h.magic));
+        h.version = fmt::version;
+        h.color_depth = LV_COLOR_DEPTH;
+        h.flags = LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP ? fmt::swap16 : 0;
+        h.width = image_w;
+        h.height = image_h;
+        h.data_size = h.stored_size = uint32_t(px.size() * sizeof(px[0]));
+        h.data_offset = sizeof(h);
+
+        const auto path = gallery_dir + "/" + std::to_string(n) + ".lvimg";
+        auto f = fopen(path.c_str(), "wb");
+        if (!f)
+            return false;
+        fwrite(&h, sizeof(h), 1, f);
+        fwrite(px.data(), sizeof(px[0]), px.size(), f);
+        fclose(f);
+    }
+    return true;
+}
+
+static void remove_gallery_images() {
+    for (int n = 0; n < gallery_images; n++)
+        remove((gallery_dir + "/" + std::to_string(n) + ".lvimg").c_str());
+    remove(gallery_dir.c_str());
+}
+
+struct gallery_screen : lvgl::screen {
+    static constexpr int columns = 3;
+    static constexpr int rows = 20;
+    static constexpr lv_coord_t cell_w = image_w + 16;
+    static constexpr lv_coord_t cell_h = image_h + 16;
+
+    std::vector<std::unique_ptr<lvgl::async_image>> images;
+    lvgl::animation scroll{[this](int32_t y) {
+        lv_obj_scroll_to_y(get_object(), y, LV_ANIM_OFF);
+    }};
+
+    gallery_screen() {
+        for (int i = 0; i < columns * rows; i++) {
+            auto &img =
+                images.emplace_back(std::make_unique<lvgl::async_image>(this));
+            img->set_pos(16 + i % columns * cell_w, 16 + i / columns * cell_h);
+            img->set_size(image_w, image_h);
+            const auto path = gallery_dir + "/" +
+                              std::to_string(i % gallery_images) + ".lvimg";
+            img->load(path.c_str());
+        }
+
+        scroll.set_range(0, 16 + rows * cell_h - ver_res);
+        scroll.set_time(4000);
+        scroll.set_playback_time(4000);
+        scroll.set_repeat(lvgl::animation::repeat_indef);
+        scroll.start();
+    }
+};
+
+struct scenario {
+    const char *name;
+    std::function<std::unique_ptr<lvgl::screen>()> make;
+    /// redraw the whole screen every frame
+    bool invalidate;
+};
+
+template <typename S> static std::unique_ptr<lvgl::screen> make() {
+    return std::make_unique<S>();
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    const auto idx = static_cast<std::size_t>(p / 100 * (v.size() - 1) + 0.5);
+    return v[idx];
+}
+
+static void print_times(FILE *out, const char *name,
+                        const std::vector<double> &ms) {
+    fprintf(out,
+            "      \"%s_ms\": {\"p50\": %.4f, \"p95\": %.4f, "
+            "\"p99\": %.4f}",
+            name, percentile(ms, 50), percentile(ms, 95), percentile(ms, 99));
+}
+
+/// bytes currently allocated through LVGL
+static int64_t mem_bytes() {
+    return lvgl::mem::take_snapshot().total().bytes;
+}
+
+static void run(FILE *out, const scenario &sc,
+                framebuffer_display_driver &disp, lvgl::screen &idle,
+                bool first) {
+    const auto before = mem_bytes();
+    auto scr = sc.make();
+    scr->set_name(sc.name);
+    lvgl::screen::load(*scr);
+    const auto mem = mem_bytes() - before;
+    auto peak = mem;
+
+    std::vector<double> render, flush;
+    bench_clock::duration busy{};
+    uint64_t pixels = 0;
+
+    for (int i = -warmup_frames; i < frames; i++) {
+        if (sc.invalidate)
+            scr->invalidate();
+        lv_tick_inc(tick_ms);
+
+        const auto flushes = disp.flush_count;
+        const auto flushed = disp.flushed_pixels;
+        disp.flush_time = {};
+
+        const auto start = bench_clock::now();
+        lvgl::ui_queue::drain();
+        lv_timer_handler();
+        const auto total = bench_clock::now() - start;
+        peak = std::max(peak, mem_bytes() - before);
+
+        if (i < 0 || disp.flush_count == flushes)
+            continue;
+
+        using ms = std::chrono::duration<double, std::milli>;
+        busy += total;
+        pixels += disp.flushed_pixels - flushed;
+        render.push_back(ms(total - disp.flush_time).count());
+        flush.push_back(ms(disp.flush_time).count());
+    }
+
+    // nothing of the scenario is left for the next one
+    lvgl::screen::load(idle);
+    scr.reset();
+
+    const double busy_s = std::chrono::duration<double>(busy).count();
+    fprintf(out, "%s    {\n", first ? "" : ",\n");
+    fprintf(out, "      \"name\": \"%s\",\n", sc.name);
+    fprintf(out, "      \"frames\": %zu,\n", render.size());
+    fprintf(out, "      \"fps\": %.1f,\n",
+            busy_s > 0 ? render.size() / busy_s : 0.0);
+    print_times(out, "render", render);
+    fprintf(out, ",\n");
+    print_times(out, "flush", flush);
+    fprintf(out, ",\n");
+    fprintf(out, "      \"flushed_kpx_per_frame\": %.1f,\n",
+            render.empty() ? 0.0 : pixels / 1000.0 / render.size());
+    fprintf(out, "      \"mem_bytes\": %lld,\n", static_cast<long long>(mem));
+    fprintf(out, "      \"mem_peak_bytes\": %lld\n",
+            static_cast<long long>(peak));
+    fprintf(out, "    }");
+}
+
+/// the demo screen without the prints of its click handler
+struct replay_screen : demo_screen {
+    void on_event(lvgl::object_ref sender, lvgl::event ev) override {
+        (void)ev;
+        if (sender == btn)
+            lbl.set_text("click");
+    }
+};
+
+/// taps on the button, checkbox and switch, then spinbox and button keys
+static lvgl::replay::recording builtin_flow() {
+    using lvgl::replay::device_type;
+    lvgl::replay::recording rec;
+    rec.devices = {device_type::pointer, device_type::keypad};
+
+    auto tap = [&rec](uint32_t t, lv_coord_t x, lv_coord_t y) {
+        rec.events.push_back({t, 0, LV_INDEV_STATE_PRESSED, x, y, 0, 0});
+        rec.events.push_back({t + 80, 0, LV_INDEV_STATE_RELEASED, x, y, 0, 0});
+    };
+    auto key = [&rec](uint32_t t, uint32_t k) {
+        rec.events.push_back({t, 1, LV_INDEV_STATE_PRESSED, 0, 0, k, 0});
+        rec.events.push_back({t + 50, 1, LV_INDEV_STATE_RELEASED, 0, 0, k, 0});
+    };
+
+    tap(200, hor_res / 2, ver_res / 2);
+    tap(600, 48, 510);
+    tap(1000, 60, 562);
+    for (uint32_t t = 1400; t < 2000; t += 200)
+        key(t, LV_KEY_UP);
+    key(2000, LV_KEY_NEXT);
+    key(2200, LV_KEY_ENTER);
+    // lets the switch and press animations finish
+    rec.events.push_back({3000, 0, LV_INDEV_STATE_RELEASED, 60, 562, 0, 0});
+    return rec;
+}
+
+struct replay_result {
+    std::vector<uint64_t> hashes;
+    std::vector<double> render, flush;
+};
+
+static replay_result replay(const lvgl::replay::recording &rec,
+                            framebuffer_display_driver &disp) {
+    struct session {
+        lvgl::replay::virtual_clock clock;
+        lvgl::replay::player player;
+
+        explicit session(const lvgl::replay::recording &rec)
+            : player{rec, clock} {}
+    };
+    // input devices can't be unregistered, so the players of earlier runs
+    // stay around and keep reading their final, released state
+    static std::vector<std::unique_ptr<session>> sessions;
+    static std::unique_ptr<replay_screen> scr;
+
+    auto next = std::make_unique<replay_screen>();
+    lvgl::screen::load(*next);
+    scr = std::move(next);
+
+    auto &s = *sessions.emplace_back(std::make_unique<session>(rec));
+    s.player.set_group(scr->grp);
+
+    // fire every timer at the same tick, so they are in the same phase
+    // relative to the recording on every run
+    for (auto t = lv_timer_get_next(nullptr); t; t = lv_timer_get_next(t))
+        lv_timer_ready(t);
+    lv_timer_handler();
+
+    replay_result res;
+    disp.flush_time = {};
+    auto last = bench_clock::now();
+    s.player.run(tick_ms, [&] {
+        using ms = std::chrono::duration<double, std::milli>;
+        const auto total = bench_clock::now() - last;
+        res.render.push_back(ms(total - disp.flush_time).count());
+        res.flush.push_back(ms(disp.flush_time).count());
+        res.hashes.push_back(disp.hash());
+        disp.flush_time = {};
+        last = bench_clock::now();
+    });
+    return res;
+}
+
+/// replays `rec` twice; false if the runs rendered different frames
+static bool run_replay(FILE *out, const lvgl::replay::recording &rec,
+                       framebuffer_display_driver &disp) {
+    const auto first = replay(rec, disp);
+    const auto second = replay(rec, disp);
+    const bool same = first.hashes == second.hashes;
+
+    fprintf(out, "  \"replay\": {\n");
+    fprintf(out, "      \"events\": %zu,\n", rec.events.size());
+    fprintf(out, "      \"frames\": %zu,\n", second.hashes.size());
+    fprintf(out, "      \"deterministic\": %s,\n", same ? "true" : "false");
+    print_times(out, "render", second.render);
+    fprintf(out, ",\n");
+    print_times(out, "flush", second.flush);
+    fprintf(out, "\n  }\n");
+    return same;
+}
+
+int main(int argc, char **argv) {
+    FILE *out = argc > 1 ? fopen(argv[1], "w") : stdout;
+    if (!out) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    auto rec = builtin_flow();
+    if (auto path = getenv("LVGL_REPLAY")) {
+        auto loaded = lvgl::replay::recording::load(path);
+        if (!loaded) {
+            fprintf(stderr, "%s: not a recording\n", path);
+            return 1;
+        }
+        rec = std::move(*loaded);
+    }
+
+    lvgl::init();
+    if (!write_gallery_images()) {
+        perror("gallery images");
+        return 1;
+    }
+
+    static lvgl::drivers::static_buffer<hor_res, ver_res / 10> buffer;
+    framebuffer_display_driver disp{buffer};
+    // refresh on every lv_timer_handler() call
+    disp.get_display().set_refresh_period(tick_ms);
+
+    const scenario scenarios[] = {
+        {"demo_screen", make<demo_screen>, true},
+        {"my_screen", make<my_screen_animated>, false},
+        {"buttons", make<buttons_screen>, true},
+        {"shadows", make<shadows_screen>, true},
+        {"gradients", make<gradients_screen>, true},
+        {"long_labels", make<labels_screen>, false},
+        {"compressed_text", make<compressed_text_screen<false>>, true},
+        {"compressed_text_cached", make<compressed_text_screen<true>>, true},
+        {"meters", make<meters_screen>, false},
+        {"gallery", make<gallery_screen>, false},
+    };
+
+    fprintf(out, "{\n  \"display\": {\"width\": %d, \"height\": %d},\n",
+            hor_res, ver_res);
+    fprintf(out, "  \"tick_ms\": %u,\n  \"scenarios\": [\n", tick_ms);
+    // shown between scenarios, so each screen can be deleted after its run
+    lvgl::screen idle;
+    bool first = true;
+    for (const auto &sc : scenarios) {
+        run(out, sc, disp, idle, first);
+        first = false;
+    }
+    fprintf(out, "\n  ],\n");
+
+    const bool deterministic = run_replay(out, rec, disp);
+    fprintf(out, "}\n");
+    remove_gallery_images();
+
+    if (out != stdout)
+        fclose(out);
+    if (!deterministic) {
+        fprintf(stderr, "replay: the two runs rendered different frames\n");
+        return 1;
+    }
+}
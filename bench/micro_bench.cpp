@@ -0,0 +1,310 @@
+#include "lvgl.hpp"
+#include "lvgl_display_driver.hpp"
+#include "lvgl_driver.hpp"
+#include <benchmark/benchmark.h>
+
+/*
+ * Cost of the C++ wrapper paths next to the LVGL calls they replace. Each
+ * wrapper benchmark has a raw counterpart doing the same work through the C
+ * API; the two should report the same time unless the wrapper adds work of
+ * its own (e.g. the allocation scopes of lvgl_mem.hpp).
+ *
+ * The wrappers delete their LVGL object when they are destroyed, the raw
+ * benchmarks delete theirs with lv_obj_del().
+ */
+
+static constexpr lv_coord_t hor_res = 800;
+static constexpr lv_coord_t ver_res = 480;
+
+class bench_display_driver
+    : public lvgl::drivers::display_driver<bench_display_driver> {
+  public:
+    static constexpr lv_coord_t hor_res = ::hor_res;
+    static constexpr lv_coord_t ver_res = ::ver_res;
+
+    uint64_t pixels = 0;
+
+    template <typename Buffer>
+    bench_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer)
+        : display_driver{buffer} {}
+
+    void flush_display(const lvgl::area_t &area, lvgl::color_t *color_p) {
+        (void)color_p;
+        pixels += uint32_t(area.get_width()) * area.get_height();
+        this->flush_ready();
+    }
+
+    /// what LVGL does to flush an area
+    void flush(const lv_area_t &area, lv_color_t *color_p) {
+        _driver.flush_cb(&_driver, &area, color_p);
+    }
+};
+
+class bench_pointer_driver
+    : public lvgl::drivers::input_pointer_driver<bench_pointer_driver> {
+  public:
+    lv_coord_t x = 10, y = 20;
+
+    void get_pointer_state(lv_coord_t &px, lv_coord_t &py,
+                           lv_indev_state_t &state) {
+        px = x;
+        py = y;
+        state = LV_INDEV_STATE_PRESSED;
+    }
+
+    /// what LVGL does to read the device
+    void read(lv_indev_data_t &data) { _driver.read_cb(&_driver, &data); }
+};
+
+/// a widget whose LVGL object the benchmarks can reach
+template <typename W> struct probe : W {
+    using W::W;
+
+    lv_obj_t *raw() { return this->get_object(); }
+};
+
+struct counting_handler : lvgl::event_handler {
+    uint64_t count = 0;
+
+    void on_event(lvgl::object_ref sender, lvgl::event ev) override {
+        (void)sender;
+        (void)ev;
+        count++;
+    }
+};
+
+namespace raw {
+
+static uint64_t pixels = 0;
+static lv_disp_drv_t disp_drv;
+static lv_indev_drv_t indev_drv;
+
+static void flush(lv_disp_drv_t *drv, const lv_area_t *area,
+                  lv_color_t *color_p) {
+    (void)color_p;
+    pixels += lv_area_get_size(area);
+    lv_disp_flush_ready(drv);
+}
+
+static void read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+    (void)drv;
+    data->point.x = 10;
+    data->point.y = 20;
+    data->state = LV_INDEV_STATE_PRESSED;
+}
+
+static void count_event(lv_event_t *e) {
+    ++*static_cast<uint64_t *>(lv_event_get_user_data(e));
+}
+
+} // namespace raw
+
+static lvgl::screen *scr;
+static bench_display_driver *disp;
+static bench_pointer_driver *pointer;
+
+static void BM_create_button_wrapper(benchmark::State &state) {
+    for (auto _ : state) {
+        probe<lvgl::button> btn{scr};
+        benchmark::DoNotOptimize(btn.raw());
+    }
+}
+BENCHMARK(BM_create_button_wrapper);
+
+static void BM_create_button_raw(benchmark::State &state) {
+    auto parent = lv_scr_act();
+    for (auto _ : state) {
+        auto btn = lv_btn_create(parent);
+        benchmark::DoNotOptimize(btn);
+        lv_obj_del(btn);
+    }
+}
+BENCHMARK(BM_create_button_raw);
+
+static void BM_set_pos_wrapper(benchmark::State &state) {
+    probe<lvgl::button> btn{scr};
+    lv_coord_t x = 0;
+    for (auto _ : state)
+        btn.set_pos(x++ & 255, 10);
+}
+BENCHMARK(BM_set_pos_wrapper);
+
+static void BM_set_pos_raw(benchmark::State &state) {
+    auto btn = lv_btn_create(lv_scr_act());
+    lv_coord_t x = 0;
+    for (auto _ : state)
+        lv_obj_set_pos(btn, x++ & 255, 10);
+    lv_obj_del(btn);
+}
+BENCHMARK(BM_set_pos_raw);
+
+static void BM_label_set_text_wrapper(benchmark::State &state) {
+    probe<lvgl::label> lbl{scr};
+    const char *texts[] = {"Hello", "world"};
+    int i = 0;
+    for (auto _ : state)
+        lbl.set_text(texts[i++ & 1]);
+}
+BENCHMARK(BM_label_set_text_wrapper);
+
+static void BM_label_set_text_raw(benchmark::State &state) {
+    auto lbl = lv_label_create(lv_scr_act());
+    const char *texts[] = {"Hello", "world"};
+    int i = 0;
+    for (auto _ : state)
+        lv_label_set_text(lbl, texts[i++ & 1]);
+    lv_obj_del(lbl);
+}
+BENCHMARK(BM_label_set_text_raw);
+
+static void BM_object_ref_temporary_wrapper(benchmark::State &state) {
+    auto btn = lv_btn_create(lv_scr_act());
+    lv_coord_t x = 0;
+    for (auto _ : state)
+        lvgl::object_ref{btn}.set_x(x++ & 255);
+    lv_obj_del(btn);
+}
+BENCHMARK(BM_object_ref_temporary_wrapper);
+
+static void BM_object_ref_temporary_raw(benchmark::State &state) {
+    auto btn = lv_btn_create(lv_scr_act());
+    lv_coord_t x = 0;
+    for (auto _ : state)
+        lv_obj_set_x(btn, x++ & 255);
+    lv_obj_del(btn);
+}
+BENCHMARK(BM_object_ref_temporary_raw);
+
+static void BM_event_dispatch_wrapper(benchmark::State &state) {
+    probe<lvgl::button> btn{scr};
+    counting_handler handler;
+    btn.add_event_handler(&handler, lvgl::event::LV_EVENT_CLICKED);
+    for (auto _ : state)
+        lv_event_send(btn.raw(), LV_EVENT_CLICKED, nullptr);
+    benchmark::DoNotOptimize(handler.count);
+}
+BENCHMARK(BM_event_dispatch_wrapper);
+
+static void BM_event_dispatch_raw(benchmark::State &state) {
+    auto btn = lv_btn_create(lv_scr_act());
+    uint64_t count = 0;
+    lv_obj_add_event_cb(btn, raw::count_event, LV_EVENT_CLICKED, &count);
+    for (auto _ : state)
+        lv_event_send(btn, LV_EVENT_CLICKED, nullptr);
+    benchmark::DoNotOptimize(count);
+    lv_obj_del(btn);
+}
+BENCHMARK(BM_event_dispatch_raw);
+
+static constexpr std::size_t grid_keys = 500;
+
+static void BM_create_grid_wrapper(benchmark::State &state) {
+    lvgl::style key_style;
+    key_style.set_bg_color(lv_palette_main(LV_PALETTE_BLUE));
+    lvgl::object grid{lv_obj_create, scr};
+    for (auto _ : state) {
+        auto keys = lvgl::make_many<lvgl::button>(
+            &grid, grid_keys, [&](lvgl::button &key, std::size_t i) {
+                key.set_pos(i % 25 * 32, i / 25 * 24);
+                key.set_size(30, 22);
+                key.add_style(key_style);
+            });
+        benchmark::DoNotOptimize(keys.data());
+
+        state.PauseTiming();
+        keys.clear();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_create_grid_wrapper);
+
+static void BM_create_grid_raw(benchmark::State &state) {
+    lv_style_t key_style;
+    lv_style_init(&key_style);
+    lv_style_set_bg_color(&key_style, lv_palette_main(LV_PALETTE_BLUE));
+    auto grid = lv_obj_create(lv_scr_act());
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < grid_keys; i++) {
+            auto key = lv_btn_create(grid);
+            lv_obj_set_pos(key, i % 25 * 32, i / 25 * 24);
+            lv_obj_set_size(key, 30, 22);
+            lv_obj_add_style(key, &key_style, 0);
+        }
+        lv_obj_update_layout(grid);
+
+        state.PauseTiming();
+        lv_obj_clean(grid);
+        state.ResumeTiming();
+    }
+    lv_obj_del(grid);
+    lv_style_reset(&key_style);
+}
+BENCHMARK(BM_create_grid_raw);
+
+static void BM_indev_read_wrapper(benchmark::State &state) {
+    lv_indev_data_t data{};
+    for (auto _ : state) {
+        pointer->read(data);
+        benchmark::DoNotOptimize(data);
+    }
+}
+BENCHMARK(BM_indev_read_wrapper);
+
+static void BM_indev_read_raw(benchmark::State &state) {
+    lv_indev_data_t data{};
+    for (auto _ : state) {
+        raw::indev_drv.read_cb(&raw::indev_drv, &data);
+        benchmark::DoNotOptimize(data);
+    }
+}
+BENCHMARK(BM_indev_read_raw);
+
+static void BM_flush_trampoline_wrapper(benchmark::State &state) {
+    const lv_area_t area{0, 0, hor_res - 1, 47};
+    for (auto _ : state)
+        disp->flush(area, nullptr);
+    benchmark::DoNotOptimize(disp->pixels);
+}
+BENCHMARK(BM_flush_trampoline_wrapper);
+
+static void BM_flush_trampoline_raw(benchmark::State &state) {
+    const lv_area_t area{0, 0, hor_res - 1, 47};
+    for (auto _ : state)
+        raw::disp_drv.flush_cb(&raw::disp_drv, &area, nullptr);
+    benchmark::DoNotOptimize(raw::pixels);
+}
+BENCHMARK(BM_flush_trampoline_raw);
+
+int main(int argc, char **argv) {
+    lvgl::init();
+
+    static lvgl::drivers::static_buffer<hor_res, 48> buffer;
+    static bench_display_driver wrapped_disp{buffer};
+    disp = &wrapped_disp;
+
+    static bench_pointer_driver wrapped_pointer;
+    pointer = &wrapped_pointer;
+
+    static lv_disp_draw_buf_t raw_buf;
+    static lv_color_t raw_pixels[hor_res * 48];
+    lv_disp_draw_buf_init(&raw_buf, raw_pixels, nullptr, hor_res * 48);
+    lv_disp_drv_init(&raw::disp_drv);
+    raw::disp_drv.hor_res = hor_res;
+    raw::disp_drv.ver_res = ver_res;
+    raw::disp_drv.draw_buf = &raw_buf;
+    raw::disp_drv.flush_cb = raw::flush;
+    lv_disp_drv_register(&raw::disp_drv);
+
+    lv_indev_drv_init(&raw::indev_drv);
+    raw::indev_drv.type = LV_INDEV_TYPE_POINTER;
+    raw::indev_drv.read_cb = raw::read;
+    lv_indev_drv_register(&raw::indev_drv);
+
+    static lvgl::screen screen;
+    lvgl::screen::load(screen);
+    scr = &screen;
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
@@ -0,0 +1,142 @@
+#include "lvgl_parallel.hpp"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <stdio.h>
+#include <vector>
+
+/*
+ * Full-screen 1080p refreshes of a busy screen with the band flush running on
+ * 1, 2, 4 and 8 threads. The flush converts the rendered ARGB8888 bands to a
+ * gamma-corrected RGB565 framebuffer, which is the typical work left to the
+ * CPU on boards without a display controller doing the conversion.
+ */
+
+static constexpr lv_coord_t hor_res = 1920;
+static constexpr lv_coord_t ver_res = 1080;
+static constexpr unsigned bands = 10;
+static constexpr int frames = 60;
+
+class rgb565_display_driver
+    : public lvgl::parallel::parallel_display_driver<rgb565_display_driver> {
+
+    std::vector<uint16_t> _fb = std::vector<uint16_t>(hor_res * ver_res);
+    std::array<uint8_t, 256> _gamma;
+
+  public:
+    static constexpr lv_coord_t hor_res = ::hor_res;
+    static constexpr lv_coord_t ver_res = ::ver_res;
+    static constexpr int buffer_count = 2;
+
+    template <typename Buffer>
+    rgb565_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer,
+                          unsigned threads)
+        : parallel_display_driver{buffer, threads} {
+        for (int i = 0; i < 256; i++)
+            _gamma[i] = uint8_t(255.0 * std::pow(i / 255.0, 1 / 2.2) + 0.5);
+    }
+
+    lv_disp_t *disp() { return _disp; }
+
+    void flush_rows(const lvgl::area_t &area, const lvgl::color_t *color_p,
+                    lv_coord_t y1, lv_coord_t y2) {
+        const auto w = area.get_width();
+        for (lv_coord_t y = y1; y <= y2; y++) {
+            auto src = color_p + (y - area.y1) * w;
+            auto dst = &_fb[y * hor_res + area.x1];
+            for (lv_coord_t x = 0; x < w; x++) {
+                const auto c = src[x];
+                dst[x] = uint16_t((_gamma[c.ch.red] >> 3) << 11 |
+                                  (_gamma[c.ch.green] >> 2) << 5 |
+                                  _gamma[c.ch.blue] >> 3);
+            }
+        }
+    }
+};
+
+struct busy_screen : lvgl::screen {
+    std::vector<std::unique_ptr<lvgl::object>> widgets;
+
+    busy_screen() {
+        for (int row = 0; row < 12; row++) {
+            for (int col = 0; col < 10; col++) {
+                const int x = 20 + col * 190;
+                const int y = 20 + row * 88;
+                switch ((row + col) % 4) {
+                case 0: {
+                    auto btn = std::make_unique<lvgl::button>(this);
+                    btn->set_pos(x, y);
+                    btn->set_size(170, 70);
+                    auto lbl = std::make_unique<lvgl::label>(btn.get());
+                    lbl->set_text("Button");
+                    lbl->align(lvgl::alignment::center);
+                    widgets.push_back(std::move(btn));
+                    widgets.push_back(std::move(lbl));
+                    break;
+                }
+                case 1: {
+                    auto bar = std::make_unique<lvgl::bar>(this);
+                    bar->set_pos(x, y + 25);
+                    bar->set_size(170, 20);
+                    bar->set_value(row * 8);
+                    widgets.push_back(std::move(bar));
+                    break;
+                }
+                case 2: {
+                    auto cb = std::make_unique<lvgl::checkbox>(this);
+                    cb->set_pos(x, y + 20);
+                    cb->set_text("Checkbox");
+                    widgets.push_back(std::move(cb));
+                    break;
+                }
+                default: {
+                    auto sl = std::make_unique<lvgl::slider>(this);
+                    sl->set_pos(x + 10, y + 30);
+                    sl->set_size(150, 10);
+                    widgets.push_back(std::move(sl));
+                    break;
+                }
+                }
+            }
+        }
+    }
+};
+
+static void wait_flush(lv_disp_t *disp) {
+    while (disp->driver->draw_buf->flushing)
+        ;
+}
+
+int main() {
+    lvgl::init();
+
+    double single = 0;
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        // displays stay registered until exit
+        auto buffer = new lvgl::parallel::band_buffer<hor_res, ver_res, bands>;
+        auto drv = new rgb565_display_driver{*buffer, threads};
+        lv_disp_set_default(drv->disp());
+
+        auto scr = new busy_screen;
+        lvgl::screen::load(*scr);
+        lv_refr_now(drv->disp());
+        wait_flush(drv->disp());
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            scr->invalidate();
+            lv_refr_now(drv->disp());
+        }
+        wait_flush(drv->disp());
+        const double ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count() /
+                          frames;
+
+        if (threads == 1)
+            single = ms;
+        printf("%u thread(s): %7.2f ms per 1080p frame, %5.2fx\n", threads,
+               ms, single / ms);
+    }
+}
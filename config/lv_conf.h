@@ -47,10 +47,10 @@
 /*Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too.*/
 #  define LV_MEM_ADR          0     /*0: unused*/
 #else       /*LV_MEM_CUSTOM*/
-#  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
-#  define LV_MEM_CUSTOM_ALLOC     malloc
-#  define LV_MEM_CUSTOM_FREE      free
-#  define LV_MEM_CUSTOM_REALLOC   realloc
+#  define LV_MEM_CUSTOM_INCLUDE "lvgl_mem.h"   /*Header for the dynamic memory function*/
+#  define LV_MEM_CUSTOM_ALLOC     lvgl_mem_alloc    /*malloc with per class/screen accounting*/
+#  define LV_MEM_CUSTOM_FREE      lvgl_mem_free
+#  define LV_MEM_CUSTOM_REALLOC   lvgl_mem_realloc
 #endif     /*LV_MEM_CUSTOM*/
 
 /*Use the standard `memcpy` and `memset` instead of LVGL's own functions. (Might or might not be faster).*/
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include <stdio.h>
+
+/*
+ * Screens of the simulator, shared with the benchmarks.
+ */
+
+class my_screen : public lvgl::screen {
+  public:
+    lvgl::button btn{this};
+    lvgl::label lbl{&btn};
+    lvgl::bar bar{this};
+    lvgl::slider slider{this};
+
+    lvgl::meter meter{this};
+    lvgl::meter::scale scale{meter.add_scale()};
+    lvgl::meter::indicator indic;
+
+    lvgl::led led{this};
+    lvgl::checkbox chkbox{this};
+    lvgl::lv_switch sw{this};
+
+    my_screen() : lvgl::screen{} {
+
+        static lvgl::style btn_style;
+
+        const void *p = nullptr;
+
+        // lvgl::style::prop_value val{lv_color_black()};
+        // lvgl::style::prop_value val{1u};
+        lvgl::style::prop_value val{p};
+
+        // btn_style.set_bg_color(lv_palette_main(LV_PALETTE_RED));
+        btn_style.set_property(LV_STYLE_BG_COLOR,
+                               lv_palette_main(LV_PALETTE_RED));
+        btn.add_style(btn_style, lvgl::state::pressed);
+
+        lbl.set_text("Hello world");
+        btn.align(lvgl::alignment::center);
+        // lbl.set_pos({50, 50});
+
+        bar.set_pos(10, 10);
+        bar.set_value(50);
+
+        slider.set_pos(10, 400);
+
+        meter.set_pos(50, 50);
+        meter.set_size(200, 200);
+        meter.set_scale_ticks(scale);
+        meter.set_scale_major_ticks(scale);
+
+        auto i =
+            meter.add_indicator_arc(scale, lv_palette_main(LV_PALETTE_BLUE));
+        meter.set_indicator_start_value(i, 0);
+        meter.set_indicator_end_value(i, 20);
+
+        i = meter.add_indicator_lines(scale, lv_palette_main(LV_PALETTE_BLUE),
+                                      lv_palette_main(LV_PALETTE_BLUE), false,
+                                      0);
+        meter.set_indicator_start_value(i, 0);
+        meter.set_indicator_end_value(i, 20);
+
+        i = meter.add_indicator_arc(scale, lv_palette_main(LV_PALETTE_RED));
+        meter.set_indicator_start_value(i, 80);
+        meter.set_indicator_end_value(i, 100);
+
+        i = meter.add_indicator_lines(scale, lv_palette_main(LV_PALETTE_RED),
+                                      lv_palette_main(LV_PALETTE_RED), false,
+                                      0);
+        meter.set_indicator_start_value(i, 80);
+        meter.set_indicator_end_value(i, 100);
+
+        i = meter.add_indicator_needle(scale, 4,
+                                       lv_palette_main(LV_PALETTE_GREY), -10);
+
+        meter.set_indicator_value(i, 50);
+
+        indic = i;
+
+        led.set_pos(20, 100);
+        led.set_color(lv_palette_main(LV_PALETTE_RED));
+        led.off();
+
+        chkbox.set_text("enable foo");
+        this->chkbox.set_pos(40, 500);
+
+        sw.set_pos(40, 550);
+    }
+};
+
+class demo_screen : public lvgl::screen, public lvgl::event_handler {
+  public:
+    lvgl::button btn{this};
+    lvgl::label lbl{&btn};
+
+    lvgl::checkbox chkbox{this};
+    lvgl::lv_switch sw{this};
+    lvgl::spinbox sb{this};
+
+    lvgl::group grp;
+
+    demo_screen() : lvgl::screen{} {
+
+        static lvgl::style btn_style;
+
+        const void *p = nullptr;
+
+        grp.add_object(sb);
+        grp.add_object(btn);
+
+        // lvgl::style::prop_value val{lv_color_black()};
+        // lvgl::style::prop_value val{1u};
+        lvgl::style::prop_value val{p};
+
+        // btn_style.set_bg_color(lv_palette_main(LV_PALETTE_RED));
+        btn_style.set_property(LV_STYLE_BG_COLOR,
+                               lv_palette_main(LV_PALETTE_RED));
+        btn.add_style(btn_style, lvgl::state::pressed);
+
+        lbl.set_text("Hello world");
+        btn.align(lvgl::alignment::center);
+
+        chkbox.set_text("enable foo");
+        this->chkbox.set_pos(40, 500);
+
+        sw.set_pos(40, 550);
+
+        // btn.add_click_handler(this);
+        btn.add_event_handler(this, lvgl::event::LV_EVENT_CLICKED);
+    }
+
+    void on_event(object_ref sender, lvgl::event ev) override {
+        printf("event %d\n", static_cast<int>(ev));
+        if (sender == btn) {
+            printf("button click\n");
+            lbl.set_text("click");
+        }
+    }
+};
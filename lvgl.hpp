@@ -1,8 +1,16 @@
 #pragma once
 
 #include "lvgl.h"
+#include "lvgl_mem.hpp"
+#include "lvgl_trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <functional>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace lvgl {
 
@@ -85,10 +93,10 @@ enum class event : int {
     _LV_EVENT_LAST /** Number of default events*/
 };
 
-class object;
+class object_ref;
 class event_handler {
   public:
-    virtual void on_event(object &sender, event ev) = 0;
+    virtual void on_event(object_ref sender, event ev) = 0;
 };
 
 using color_t = lv_color_t;
@@ -114,34 +122,102 @@ namespace drivers {
 class display;
 }
 
-class theme {
-    friend class drivers::display;
-    lv_theme_t *_theme;
-
-  public:
-    theme(lv_color_t color_primary, lv_color_t color_secondary, bool dark,
-          const lv_font_t *font)
-        : _theme{lv_theme_default_init(nullptr, color_primary, color_secondary,
-                                       dark, font)} {}
-};
-
-class timer {
-    lv_timer_t *_timer;
+/**
+ * @brief Periodic timer calling `F` on the LVGL thread.
+ *
+ * The callable is stored inline. The timer starts running on construction;
+ * with a repeat count it stops after that many calls and can be restarted.
+ * Timers reference themselves from LVGL, so they can be neither copied nor
+ * moved.
+ */
+template <typename F> class basic_timer {
+    lv_timer_t *_timer = nullptr;
+    F _fn;
+    uint32_t _period;
+    int32_t _repeat;
 
     static void callback(lv_timer_t *tmr) {
-        auto self = reinterpret_cast<timer *>(tmr->user_data);
+        auto self = static_cast<basic_timer *>(tmr->user_data);
         if (tmr->repeat_count == 0) {
             // if repeat_count reaches 0 -> timer gets deleted
             self->_timer = nullptr;
         }
+        // may destroy the timer object, so it has to be the last access
+        self->_fn();
     }
 
   public:
-    timer() : _timer{lv_timer_create_basic()} {}
+    static constexpr int32_t repeat_indef = -1;
+
+    basic_timer(F fn, uint32_t period, int32_t repeat = repeat_indef)
+        : _fn{std::move(fn)}, _period{period}, _repeat{repeat} {
+        restart();
+    }
+
+    ~basic_timer() {
+        if (_timer)
+            lv_timer_del(_timer);
+    }
+
+    basic_timer(const basic_timer &) = delete;
+    basic_timer &operator=(const basic_timer &) = delete;
+
+    /**
+     * @brief Start over with the full repeat count, also after the timer
+     * expired.
+     */
+    void restart() {
+        if (_timer) {
+            lv_timer_set_repeat_count(_timer, _repeat);
+            lv_timer_reset(_timer);
+            lv_timer_resume(_timer);
+        } else {
+            _timer = lv_timer_create(callback, _period, this);
+            lv_timer_set_repeat_count(_timer, _repeat);
+        }
+    }
+
+    /// false once the repeat count is used up
+    bool is_active() const { return _timer != nullptr; }
+
+    void set_period(uint32_t ms) {
+        _period = ms;
+        if (_timer)
+            lv_timer_set_period(_timer, ms);
+    }
+
+    auto get_period() const { return _period; }
+
+    /// takes effect with the next restart()
+    void set_repeat(int32_t count) { _repeat = count; }
+
+    void pause() {
+        if (_timer)
+            lv_timer_pause(_timer);
+    }
 
-    ~timer() { lv_timer_del(_timer); }
+    void resume() {
+        if (_timer)
+            lv_timer_resume(_timer);
+    }
+
+    bool is_paused() const { return _timer && _timer->paused; }
+
+    /// call at the next lv_timer_handler() run
+    void ready() {
+        if (_timer)
+            lv_timer_ready(_timer);
+    }
+
+    /// restart the current period
+    void reset() {
+        if (_timer)
+            lv_timer_reset(_timer);
+    }
 };
 
+using timer = basic_timer<std::function<void()>>;
+
 static inline void init() { lv_init(); }
 
 enum class flag : lv_obj_flag_t {
@@ -194,7 +270,8 @@ enum class state {
 };
 
 class style {
-    friend class object;
+    friend class object_ref;
+    friend class theme;
     lv_style_t _obj;
 
   public:
@@ -233,6 +310,50 @@ class style {
     void reset() { lv_style_reset(&_obj); }
 };
 
+class theme {
+    friend class drivers::display;
+    lv_theme_t *_theme;
+    lv_theme_t _derived{};
+    lv_style_t *_extra = nullptr;
+    lv_style_selector_t _selector = 0;
+
+    static void apply_extra(lv_theme_t *th, lv_obj_t *obj) {
+        auto self = static_cast<theme *>(th->user_data);
+        if (!lv_obj_get_parent(obj))
+            lv_obj_add_style(obj, self->_extra, self->_selector);
+    }
+
+  public:
+    /**
+     * @brief The LVGL default theme.
+     *
+     * LVGL keeps a single default theme, re-initializing it changes it for
+     * every display using it. Use the deriving constructor to give displays
+     * different looks.
+     */
+    theme(lv_color_t color_primary, lv_color_t color_secondary, bool dark,
+          const lv_font_t *font)
+        : _theme{lv_theme_default_init(nullptr, color_primary, color_secondary,
+                                       dark, font)} {}
+
+    /**
+     * @brief Theme based on `base` that adds `extra` to every screen.
+     *
+     * Inherited properties such as text color and font propagate from the
+     * screen to its widgets. `base` and `extra` must outlive the theme.
+     */
+    theme(const theme &base, style &extra, state st = state::def)
+        : _theme{&_derived}, _derived{*base._theme}, _extra{&extra._obj},
+          _selector{static_cast<lv_style_selector_t>(st)} {
+        lv_theme_set_parent(&_derived, base._theme);
+        lv_theme_set_apply_cb(&_derived, apply_extra);
+        _derived.user_data = this;
+    }
+
+    theme(const theme &) = delete;
+    theme &operator=(const theme &) = delete;
+};
+
 struct coord {
     coord_t x;
     coord_t y;
@@ -255,19 +376,21 @@ enum class alignment {
     bottom_right = LV_ALIGN_BOTTOM_RIGHT,
 };
 
+/**
+ * @brief Widget view of an object owned elsewhere, e.g. the active screen.
+ *
+ * Must not be moved into an owning wrapper. Plain handles are object_ref.
+ */
 template <typename T> class non_owning_wrapper : public T {
 
   public:
     template <typename... Args>
     non_owning_wrapper(Args... args) : T{std::forward<Args>(args)...} {}
 
-    // non_owning_wrapper(const non_owning_wrapper &o) = default;
-    ~non_owning_wrapper() { this->release(); }
+    non_owning_wrapper(const non_owning_wrapper &) = delete;
+    non_owning_wrapper &operator=(const non_owning_wrapper &) = delete;
 
-    auto operator=(const T &o) {
-        T::operator=(o);
-        return *this;
-    }
+    ~non_owning_wrapper() { this->release(); }
 };
 
 template <typename T> class owning_wrapper : public T {
@@ -277,73 +400,55 @@ template <typename T> class owning_wrapper : public T {
 };
 
 /**
- * @brief base-class for all lvgl-gui-objects.
+ * @brief Non-owning handle to an LVGL object.
  *
+ * Trivially copyable, so it can be passed and stored by value. It is only
+ * valid as long as the object it refers to.
  */
-class object {
-    lv_obj_t *_obj;
-
-  protected:
-    friend class non_owning_wrapper<object>;
+class object_ref {
+    friend class object;
     friend class group;
+    friend class footprint;
 
-    object(lv_obj_t *obj) : _obj{obj} {}
+    template <typename T, typename Init>
+    friend std::vector<T> make_many(object_ref parent, std::size_t n,
+                                    Init init);
 
+    lv_obj_t *_obj;
+
+  protected:
     auto get_object() { return _obj; }
 
     auto get_object() const { return _obj; }
 
-    void release() { _obj = nullptr; }
-
-    //~object() { lv_obj_del(_obj); }
-
   public:
-    template <typename CTOR, typename... Args>
-    object(CTOR ctor, object *parent, Args... args)
-        : _obj{ctor(parent ? parent->_obj : nullptr,
-                    std::forward<Args>(args)...)} {}
+    explicit object_ref(lv_obj_t *obj) : _obj{obj} {}
 
-    object(object *parent)
-        : _obj{lv_obj_create(parent ? parent->_obj : nullptr)} {}
+    /// lets widgets be passed as parent by pointer; nullptr creates a screen
+    object_ref(const object_ref *o) : _obj{o ? o->_obj : nullptr} {}
 
-    ~object() {
-        // if constexpr (Owning)
-        if (_obj)
-            lv_obj_del(_obj);
+    bool operator==(const object_ref &other) const {
+        return _obj == other._obj;
     }
 
-    bool operator==(const object &other) const { return _obj == other._obj; }
-
-    auto get_parent() const {
-        return non_owning_wrapper<object>(lv_obj_get_parent(_obj));
+    object_ref get_parent() const {
+        return object_ref{lv_obj_get_parent(_obj)};
     }
 
     void add_event_handler(event_handler *handler, event filter) {
+        mem::scope s{_obj};
         lv_obj_add_event_cb(
             _obj,
             [](lv_event_t *ev) {
+                LVGL_TRACE_SCOPE("event");
                 auto h = reinterpret_cast<event_handler *>(ev->user_data);
-                if (h) {
-                    auto sender = non_owning_wrapper<object>(ev->target);
-                    h->on_event(sender, static_cast<event>(ev->code));
-                }
+                if (h)
+                    h->on_event(object_ref{ev->target},
+                                static_cast<event>(ev->code));
             },
             static_cast<lv_event_code_t>(filter), handler);
     }
 
-    /**
-     * @brief Defer deletion of the object
-     *
-     * After calling delete_later(), the object must not be used any longer by
-     * application-code, i.e. the user is not allowed to call any method of the
-     * object.
-     *
-     */
-    void delete_later() {
-        lv_obj_del_async(_obj);
-        release();
-    }
-
     void set_width(coord_t w) { lv_obj_set_width(_obj, w); }
     void set_height(coord_t h) { lv_obj_set_height(_obj, h); }
     void set_size(lvgl::size s) { lv_obj_set_size(_obj, s.width, s.height); }
@@ -373,9 +478,15 @@ class object {
     }
 
     void add_style(style &s, state st = state::def) {
+        mem::scope m{_obj};
         lv_obj_add_style(_obj, &s._obj, static_cast<lv_style_selector_t>(st));
     }
 
+    /**
+     * @brief Mark the whole object for redraw.
+     */
+    void invalidate() const { lv_obj_invalidate(_obj); }
+
     void move_foreground() { lv_obj_move_foreground(_obj); }
 
     void move_background() { lv_obj_move_background(_obj); }
@@ -384,6 +495,138 @@ class object {
     // void move_down() { lv_obj_move_down(_obj); }
 };
 
+static_assert(std::is_trivially_copyable_v<object_ref>);
+
+/**
+ * @brief base-class for all lvgl-gui-objects.
+ *
+ * Owns its LVGL object and deletes it on destruction. Objects can be moved,
+ * e.g. kept in a std::vector, but not copied; use object_ref to refer to
+ * them elsewhere. When LVGL deletes the object first, e.g. together with its
+ * parent, the wrapper is told through LV_EVENT_DELETE and deletes nothing.
+ */
+class object : public object_ref {
+  protected:
+    friend class non_owning_wrapper<object>;
+
+    object(lv_obj_t *obj) : object_ref{obj} {}
+
+    lv_obj_t *release() {
+        retarget(_obj, this, nullptr);
+        return std::exchange(_obj, nullptr);
+    }
+
+  private:
+    template <typename CTOR, typename... Args>
+    static lv_obj_t *create(CTOR ctor, lv_obj_t *parent, Args... args) {
+        mem::scope s{reinterpret_cast<const void *>(ctor), parent};
+        auto obj = ctor(parent, std::forward<Args>(args)...);
+        s.bind(obj);
+        return obj;
+    }
+
+    static void on_delete(lv_event_t *ev) {
+        if (auto self = reinterpret_cast<object *>(ev->user_data))
+            self->_obj = nullptr;
+    }
+
+    /// hand the delete callback registered for `from` over to `to`
+    static void retarget(lv_obj_t *obj, const object *from, object *to) {
+        if (!obj || !obj->spec_attr)
+            return;
+        auto spec = obj->spec_attr;
+        for (uint32_t i = 0; i < spec->event_dsc_cnt; i++) {
+            auto &dsc = spec->event_dsc[i];
+            if (dsc.cb == on_delete && dsc.user_data == from)
+                dsc.user_data = to;
+        }
+    }
+
+  public:
+    template <typename CTOR, typename... Args>
+    object(CTOR ctor, object_ref parent, Args... args)
+        : object_ref{create(ctor, parent._obj, std::forward<Args>(args)...)} {
+        mem::scope s{_obj};
+        lv_obj_add_event_cb(_obj, on_delete, LV_EVENT_DELETE, this);
+    }
+
+    object(object_ref parent) : object{lv_obj_create, parent} {}
+
+    object(const object &) = delete;
+    object &operator=(const object &) = delete;
+
+    object(object &&other) noexcept
+        : object_ref{std::exchange(other._obj, nullptr)} {
+        retarget(_obj, &other, this);
+    }
+
+    object &operator=(object &&other) noexcept {
+        if (this != &other) {
+            if (_obj)
+                lv_obj_del(_obj);
+            _obj = std::exchange(other._obj, nullptr);
+            retarget(_obj, &other, this);
+        }
+        return *this;
+    }
+
+    virtual ~object() {
+        if (_obj)
+            lv_obj_del(_obj);
+    }
+
+    /**
+     * @brief Defer deletion of the object
+     *
+     * After calling delete_later(), the object must not be used any longer by
+     * application-code, i.e. the user is not allowed to call any method of the
+     * object.
+     *
+     */
+    void delete_later() { lv_obj_del_async(release()); }
+};
+
+/**
+ * @brief Create `n` widgets of type T below `parent` in one go.
+ *
+ * The parent's child array is reserved once (see mem::reserve()) and the
+ * parent is hidden while the widgets are created, so adding and placing them
+ * neither moves the array nor invalidates anything. The layout is updated
+ * once at the end. `init(widget, index)` is called for every new widget;
+ * styles it adds are shared by reference.
+ */
+template <typename T, typename Init>
+std::vector<T> make_many(object_ref parent, std::size_t n, Init init) {
+    std::vector<T> widgets;
+    if (n == 0)
+        return widgets;
+    widgets.reserve(n);
+
+    auto obj = parent._obj;
+    {
+        mem::scope s{obj};
+        lv_obj_allocate_spec_attr(obj);
+        auto attr = obj->spec_attr;
+        // without children the array may be LVGL's zero-size sentinel
+        const auto cnt = attr->child_cnt;
+        if (auto children = mem::reserve(cnt ? attr->children : nullptr,
+                                         (cnt + n) * sizeof(lv_obj_t *)))
+            attr->children = static_cast<lv_obj_t **>(children);
+    }
+
+    const bool hidden = lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+
+    for (std::size_t i = 0; i < n; i++)
+        init(widgets.emplace_back(parent), i);
+
+    if (!hidden)
+        lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_update_layout(obj);
+
+    return widgets;
+}
+
 class group {
     friend class lvgl::drivers::keyboard_input_driver_base;
     lv_group_t *_obj;
@@ -393,7 +636,7 @@ class group {
 
     ~group() { lv_group_del(_obj); }
 
-    void add_object(const object &o) { lv_group_add_obj(_obj, o._obj); }
+    void add_object(object_ref o) { lv_group_add_obj(_obj, o._obj); }
 };
 
 class screen : public object {
@@ -423,6 +666,13 @@ class screen : public object {
 
     static void load(screen &s) { lv_scr_load(s.get_object()); }
 
+    /**
+     * @brief Name the screen in memory reports (see lvgl_mem.hpp).
+     */
+    void set_name(const char *name) {
+        mem::set_screen_name(get_object(), name);
+    }
+
     static void load(screen &s, load_anim anim, uint32_t time,
                      uint32_t delay = 0) {
         lv_scr_load_anim(s.get_object(), static_cast<lv_scr_load_anim_t>(anim),
@@ -433,19 +683,44 @@ class screen : public object {
 class button : public object {
 
   public:
-    button(object *parent) : object{lv_btn_create, parent} {}
+    button(object_ref parent) : object{lv_btn_create, parent} {}
 };
 
 class label : public object {
   public:
-    label(object *parent) : object{lv_label_create, parent} {}
+    enum class long_mode {
+        wrap = LV_LABEL_LONG_WRAP,
+        dot = LV_LABEL_LONG_DOT,
+        scroll = LV_LABEL_LONG_SCROLL,
+        scroll_circular = LV_LABEL_LONG_SCROLL_CIRCULAR,
+        clip = LV_LABEL_LONG_CLIP
+    };
 
-    void set_text(const char *txt) { lv_label_set_text(get_object(), txt); }
+    label(object_ref parent) : object{lv_label_create, parent} {}
+
+    void set_long_mode(long_mode mode) {
+        lv_label_set_long_mode(get_object(),
+                               static_cast<lv_label_long_mode_t>(mode));
+    }
+
+    /**
+     * @brief Set the text; unchanged text is neither copied nor re-measured.
+     *
+     * Passing the label's own buffer (or nullptr) still refreshes it, after
+     * the text was edited in place.
+     */
+    void set_text(const char *txt) {
+        const auto cur = lv_label_get_text(get_object());
+        if (txt && txt != cur && !strcmp(cur, txt))
+            return;
+        mem::scope s{get_object()};
+        lv_label_set_text(get_object(), txt);
+    }
 };
 
 class bar : public object {
   public:
-    bar(object *parent) : object{lv_bar_create, parent} {}
+    bar(object_ref parent) : object{lv_bar_create, parent} {}
 
     auto get_value() const { lv_bar_get_value(get_object()); }
 
@@ -456,7 +731,7 @@ class bar : public object {
 
 class slider : public object {
   public:
-    slider(object *parent) : object{lv_slider_create, parent} {}
+    slider(object_ref parent) : object{lv_slider_create, parent} {}
 
     auto get_value() const { lv_slider_get_value(get_object()); }
 
@@ -467,7 +742,7 @@ class slider : public object {
 
 class spinbox : public object {
   public:
-    spinbox(object *parent) : object{lv_spinbox_create, parent} {}
+    spinbox(object_ref parent) : object{lv_spinbox_create, parent} {}
 
     auto get_value() const { lv_spinbox_get_value(get_object()); }
 
@@ -496,22 +771,28 @@ class meter : public object {
         indicator() : _obj{nullptr} {}
     };
 
-    meter(object *parent) : object{lv_meter_create, parent} {}
+    meter(object_ref parent) : object{lv_meter_create, parent} {}
 
-    scale add_scale() { return scale{lv_meter_add_scale(this->get_object())}; }
+    scale add_scale() {
+        mem::scope m{get_object()};
+        return scale{lv_meter_add_scale(this->get_object())};
+    }
 
     indicator add_indicator_arc(scale s, lv_color_t color) {
+        mem::scope m{get_object()};
         return indicator{lv_meter_add_arc(get_object(), s._obj, 3, color, 0)};
     }
 
     indicator add_indicator_lines(scale s, lv_color_t color, lv_color_t color2,
                                   bool local, int16_t mod) {
+        mem::scope m{get_object()};
         return indicator{lv_meter_add_scale_lines(get_object(), s._obj, color,
                                                   color2, local, mod)};
     }
 
     indicator add_indicator_needle(scale s, uint16_t width, lv_color_t color,
                                    int16_t mod) {
+        mem::scope m{get_object()};
         return indicator{
             lv_meter_add_needle_line(get_object(), s._obj, width, color, mod)};
     }
@@ -542,7 +823,7 @@ class meter : public object {
 class led : public object {
 
   public:
-    led(object *parent) : object{lv_led_create, parent} {}
+    led(object_ref parent) : object{lv_led_create, parent} {}
 
     void set_color(lv_color_t color) { lv_led_set_color(get_object(), color); }
 
@@ -596,7 +877,7 @@ template <size_t N> class msg_box : private msg_box_base<N>, public object {
         return out; // std::array<const char *, N + 1>{inp, nullptr};
     }
 
-    // msg_box(object *parent, const char *title, const char *txt,
+    // msg_box(object_ref parent, const char *title, const char *txt,
     //        const char *btn_texts[], bool add_close)
     //    : object{lv_msgbox_create, parent, title, txt, btn_texts,
     //    add_close}
@@ -604,7 +885,7 @@ template <size_t N> class msg_box : private msg_box_base<N>, public object {
 
 #if 1
     // template <size_t I>
-    msg_box(object *parent, const char *title, const char *txt,
+    msg_box(object_ref parent, const char *title, const char *txt,
             const std::array<const char *, N> &btns, bool add_close)
         : msg_box_base<N>{btns}, object{lv_msgbox_create,
                                         parent,
@@ -612,9 +893,13 @@ template <size_t N> class msg_box : private msg_box_base<N>, public object {
                                         txt,
                                         msg_box_base<N>::get_button_texts(),
                                         add_close} {}
+
+    // lv_msgbox keeps pointing at the button texts
+    msg_box(msg_box &&) = delete;
+    msg_box &operator=(msg_box &&) = delete;
 #else
     template <size_t N>
-    msg_box(object *parent, const char *title, const char *txt,
+    msg_box(object_ref parent, const char *title, const char *txt,
             std::array<const char *, N> &btns, bool add_close)
         : msg_box{parent, title, txt, &btns[0], add_close} {}
 #endif
@@ -622,9 +907,10 @@ template <size_t N> class msg_box : private msg_box_base<N>, public object {
 
 class checkbox : public object {
   public:
-    checkbox(object *parent) : object{lv_checkbox_create, parent} {}
+    checkbox(object_ref parent) : object{lv_checkbox_create, parent} {}
 
     void set_text(const char *text) {
+        mem::scope s{get_object()};
         lv_checkbox_set_text(get_object(), text);
     }
 
@@ -645,7 +931,7 @@ class checkbox : public object {
 class lv_switch : public object {
 
   public:
-    lv_switch(object *parent) : object{lv_switch_create, parent} {}
+    lv_switch(object_ref parent) : object{lv_switch_create, parent} {}
 
     bool is_on() const {
         return lv_obj_get_state(get_object()) == LV_STATE_CHECKED;
@@ -658,7 +944,7 @@ class lv_switch : public object {
 class text_field : public object {
 
   public:
-    text_field(object *parent) : object{lv_textarea_create, parent} {}
+    text_field(object_ref parent) : object{lv_textarea_create, parent} {}
 
     void add_char(char c) { lv_textarea_add_char(get_object(), c); }
 
@@ -673,6 +959,7 @@ class text_field : public object {
     auto get_text() const { return lv_textarea_get_text(get_object()); }
 
     void set_text(const char *text) {
+        mem::scope s{get_object()};
         lv_textarea_set_text(get_object(), text);
     }
 };
@@ -681,7 +968,7 @@ class calendar : public object {
   public:
     using date = lv_calendar_date_t;
 
-    calendar(object *parent) : object{lv_calendar_create, parent} {}
+    calendar(object_ref parent) : object{lv_calendar_create, parent} {}
 
     auto get_date() const {
         auto d = lv_calendar_get_showed_date(get_object());
@@ -693,37 +980,41 @@ class calendar : public object {
     }
 };
 
-class animation {
-    using callback_type = std::function<void(int32_t)>;
-
+/**
+ * @brief Controls shared by all animation types.
+ *
+ * Derived classes own the callable storage and pass its address as the
+ * animation variable. Animations reference themselves while running, so they
+ * can be neither copied nor moved.
+ */
+class animation_base {
+  protected:
     lv_anim_t _obj;
-    callback_type cb;
-
-  public:
-    static constexpr uint16_t repeat_indef = 0xffff;
-
-    animation(std::function<void(int32_t)> fn) : cb{fn} {
+    /// the running animation as it was when paused, only used by resume()
+    lv_anim_t _paused_state;
+    bool _paused = false;
+
+    // WARNING: do not use 'this' as variable! if the var has the same
+    // address as lv_anim_t, the behaviour is somehow different (see
+    // lv_anim.c:97)
+    animation_base(void *var, lv_anim_exec_xcb_t exec) {
         lv_anim_init(&_obj);
-
-        lv_anim_set_exec_cb(&_obj, [](void *ctx, int32_t val) {
-            auto a = reinterpret_cast<animation::callback_type *>(ctx);
-            (*a)(val);
-        });
-
-        // WARNING: do not set 'this' as variable! if the var has the same
-        // address as lv_anim_t, the behaviour is somehow different (see
-        // lv_anim.c:97)
-        lv_anim_set_var(&_obj, &cb);
+        lv_anim_set_var(&_obj, var);
+        lv_anim_set_exec_cb(&_obj, exec);
     }
 
-    ~animation() { lv_anim_del(_obj.var, _obj.exec_cb); }
+    ~animation_base() { lv_anim_del(_obj.var, _obj.exec_cb); }
 
-    void set_range(int32_t from, int32_t to) {
-        lv_anim_set_values(&_obj, from, to);
-    }
+  public:
+    static constexpr uint16_t repeat_indef = LV_ANIM_REPEAT_INFINITE;
+
+    animation_base(const animation_base &) = delete;
+    animation_base &operator=(const animation_base &) = delete;
 
     void set_time(uint32_t ms) { lv_anim_set_time(&_obj, ms); }
 
+    void set_delay(uint32_t ms) { lv_anim_set_delay(&_obj, ms); }
+
     void set_playback_time(uint32_t ms) {
         lv_anim_set_playback_time(&_obj, ms);
     }
@@ -736,11 +1027,159 @@ class animation {
         lv_anim_set_repeat_delay(&_obj, delay);
     }
 
-    void start() { lv_anim_start(&_obj); }
+    void set_repeat(uint16_t count) { lv_anim_set_repeat_count(&_obj, count); }
+
+    void set_path(lv_anim_path_cb_t path) { lv_anim_set_path_cb(&_obj, path); }
+
+    void start() {
+        _paused = false;
+        lv_anim_start(&_obj);
+    }
+
+    void stop() {
+        _paused = false;
+        lv_anim_del(_obj.var, _obj.exec_cb);
+    }
+
+    bool is_running() const {
+        return lv_anim_get(_obj.var, _obj.exec_cb) != nullptr;
+    }
 
-    void stop() {}
+    bool is_paused() const { return _paused; }
 
-    void set_repeat(uint16_t count) { lv_anim_set_repeat_count(&_obj, count); }
+    /**
+     * @brief Freeze the animation at its current value.
+     *
+     * The running state (elapsed time, playback direction, remaining repeats)
+     * is kept apart from the configuration, resume() continues from there.
+     * start() still starts over.
+     */
+    void pause() {
+        if (auto running = lv_anim_get(_obj.var, _obj.exec_cb)) {
+            _paused_state = *running;
+            lv_anim_del(_obj.var, _obj.exec_cb);
+            _paused = true;
+        }
+    }
+
+    void resume() {
+        if (!_paused)
+            return;
+
+        _paused = false;
+        // the value is already applied, don't jump back to the start value
+        lv_anim_set_early_apply(&_paused_state, false);
+        lv_anim_start(&_paused_state);
+    }
+};
+
+/**
+ * @brief Animation calling `F` with the current value on every frame.
+ *
+ * The callable is stored inline and invoked directly, without type erasure.
+ */
+template <typename F> class basic_animation : public animation_base {
+    F _fn;
+
+    static void exec(void *var, int32_t val) {
+        LVGL_TRACE_SCOPE("anim");
+        (*static_cast<F *>(var))(val);
+    }
+
+  public:
+    explicit basic_animation(F fn)
+        : animation_base{&_fn, exec}, _fn{std::move(fn)} {}
+
+    void set_range(int32_t from, int32_t to) {
+        lv_anim_set_values(&_obj, from, to);
+    }
+};
+
+using animation = basic_animation<std::function<void(int32_t)>>;
+
+/**
+ * @brief One value animated by a timeline.
+ *
+ * Runs linearly from `from` to `to` during [delay, delay + time] of the
+ * timeline's clock and holds the end values outside of that window.
+ */
+template <typename F> struct track {
+    F fn;
+    int32_t from;
+    int32_t to;
+    uint32_t time;
+    uint32_t delay = 0;
+
+    uint32_t end() const { return delay + time; }
+
+    void advance(int32_t now) {
+        const int32_t len = std::max<int32_t>(static_cast<int32_t>(time), 1);
+        const int32_t t =
+            std::clamp<int32_t>(now - static_cast<int32_t>(delay), 0, len);
+        fn(from + static_cast<int32_t>((int64_t{to} - from) * t / len));
+    }
+};
+
+template <typename F>
+track<F> make_track(F fn, int32_t from, int32_t to, uint32_t time,
+                    uint32_t delay = 0) {
+    return {std::move(fn), from, to, time, delay};
+}
+
+/**
+ * @brief Group of tracks advanced by a single animation.
+ *
+ * The timeline's value is its elapsed time in ms; all tracks are updated from
+ * it in one pass per frame. Path, playback and repeat settings apply to the
+ * shared clock.
+ */
+template <typename... Fs> class timeline : public animation_base {
+    using tracks_type = std::tuple<track<Fs>...>;
+
+    tracks_type _tracks;
+
+    static void exec(void *var, int32_t now) {
+        LVGL_TRACE_SCOPE("anim");
+        std::apply([now](auto &...t) { (t.advance(now), ...); },
+                   *static_cast<tracks_type *>(var));
+    }
+
+  public:
+    explicit timeline(track<Fs>... tracks)
+        : animation_base{&_tracks, exec}, _tracks{std::move(tracks)...} {
+        const uint32_t duration = std::max({uint32_t{0}, tracks.end()...});
+        lv_anim_set_values(&_obj, 0, static_cast<int32_t>(duration));
+        set_time(duration);
+    }
+};
+
+/**
+ * @brief Timeline of `N` tracks sharing one callable type, e.g. a lambda
+ * created in a loop for a row of identical widgets.
+ */
+template <typename F, std::size_t N>
+class timeline_array : public animation_base {
+    using tracks_type = std::array<track<F>, N>;
+
+    tracks_type _tracks;
+
+    static void exec(void *var, int32_t now) {
+        LVGL_TRACE_SCOPE("anim");
+        for (auto &t : *static_cast<tracks_type *>(var))
+            t.advance(now);
+    }
+
+  public:
+    explicit timeline_array(tracks_type tracks)
+        : animation_base{&_tracks, exec}, _tracks{std::move(tracks)} {
+        uint32_t duration = 0;
+        for (auto &t : _tracks)
+            duration = std::max(duration, t.end());
+        lv_anim_set_values(&_obj, 0, static_cast<int32_t>(duration));
+        set_time(duration);
+    }
+
+    auto &operator[](std::size_t i) { return _tracks[i]; }
 };
 
 } // namespace lvgl
\ No newline at end of file
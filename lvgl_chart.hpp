@@ -0,0 +1,582 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace lvgl {
+
+class chart : public object {
+  public:
+    enum class type {
+        none = LV_CHART_TYPE_NONE,
+        line = LV_CHART_TYPE_LINE,
+        bar = LV_CHART_TYPE_BAR,
+        scatter = LV_CHART_TYPE_SCATTER
+    };
+
+    enum class update_mode {
+        shift = LV_CHART_UPDATE_MODE_SHIFT,
+        circular = LV_CHART_UPDATE_MODE_CIRCULAR
+    };
+
+    enum class axis {
+        primary_y = LV_CHART_AXIS_PRIMARY_Y,
+        secondary_y = LV_CHART_AXIS_SECONDARY_Y,
+        primary_x = LV_CHART_AXIS_PRIMARY_X,
+        secondary_x = LV_CHART_AXIS_SECONDARY_X
+    };
+
+    class series {
+        friend class chart;
+        lv_chart_series_t *_obj;
+
+        series(lv_chart_series_t *obj) : _obj{obj} {}
+
+      public:
+        series() : _obj{nullptr} {}
+    };
+
+    chart(object_ref parent) : object{lv_chart_create, parent} {}
+
+    void set_type(type t) {
+        lv_chart_set_type(get_object(), static_cast<lv_chart_type_t>(t));
+    }
+
+    void set_update_mode(update_mode m) {
+        _mode = m;
+        lv_chart_set_update_mode(get_object(),
+                                 static_cast<lv_chart_update_mode_t>(m));
+    }
+
+    void set_point_count(uint16_t cnt) {
+        lv_chart_set_point_count(get_object(), cnt);
+    }
+
+    auto get_point_count() const {
+        return lv_chart_get_point_count(get_object());
+    }
+
+    void set_range(axis a, coord_t min, coord_t max) {
+        lv_chart_set_range(get_object(), static_cast<lv_chart_axis_t>(a), min,
+                           max);
+    }
+
+    series add_series(lv_color_t color, axis a = axis::primary_y) {
+        return series{lv_chart_add_series(get_object(), color,
+                                          static_cast<lv_chart_axis_t>(a))};
+    }
+
+    void set_next_value(series s, coord_t value) {
+        lv_chart_set_next_value(get_object(), s._obj, value);
+    }
+
+    void refresh() { lv_chart_refresh(get_object()); }
+
+  protected:
+    update_mode _mode = update_mode::shift;
+
+    static auto get_series(series s) { return s._obj; }
+
+    /**
+     * @brief Invalidate the plot area covered by the drawn positions
+     * [first, last].
+     *
+     * Mirrors the geometry lv_chart uses for its own per-point invalidation,
+     * but covers a whole run of points with a single area. Positions are
+     * counted from the left edge of the plot, i.e. in shift mode relative to
+     * the series' start point.
+     */
+    void invalidate_points(uint16_t first, uint16_t last) {
+        auto obj = get_object();
+        const int32_t cnt = get_point_count();
+
+        if (cnt < 2) {
+            lv_obj_invalidate(obj);
+            return;
+        }
+
+        const int32_t w =
+            (int32_t{lv_obj_get_content_width(obj)} *
+             lv_chart_get_zoom_x(obj)) >>
+            8;
+        const coord_t x_ofs = obj->coords.x1 +
+                              lv_obj_get_style_pad_left(obj, LV_PART_MAIN) +
+                              lv_obj_get_style_border_width(obj, LV_PART_MAIN) -
+                              lv_obj_get_scroll_left(obj);
+        const coord_t extra =
+            lv_obj_get_style_line_width(obj, LV_PART_ITEMS) +
+            lv_obj_get_style_width(obj, LV_PART_INDICATOR);
+
+        // the line segments to both neighbours of the run change as well
+        const int32_t from = first > 0 ? first - 1 : 0;
+        const int32_t to = std::min<int32_t>(last + 1, cnt - 1);
+
+        lv_area_t a = obj->coords;
+        a.y1 -= extra;
+        a.y2 += extra;
+        a.x1 = static_cast<coord_t>(w * from / (cnt - 1) + x_ofs - extra);
+        a.x2 = static_cast<coord_t>(w * to / (cnt - 1) + x_ofs + extra);
+        lv_obj_invalidate_area(obj, &a);
+    }
+};
+
+/**
+ * @brief Chart for continuously streamed samples.
+ *
+ * Every series is backed by a fixed ring of `Capacity` points that is handed
+ * to lv_chart as external array. Pushing samples only writes the new values
+ * and moves the series' start index; existing data is never moved and no
+ * memory is allocated after construction.
+ */
+template <std::size_t Capacity, std::size_t Series = 1>
+class stream_chart : public chart {
+    static_assert(Capacity >= 2 &&
+                      Capacity <= std::numeric_limits<uint16_t>::max(),
+                  "lv_chart supports at most 65535 points per series");
+    static_assert(Series > 0, "stream_chart needs at least one series");
+
+    std::array<std::array<coord_t, Capacity>, Series> _buffers;
+    std::array<series, Series> _series;
+
+    static coord_t clamp(int32_t v) {
+        // LV_CHART_POINT_NONE marks a gap and must not be produced by data
+        return static_cast<coord_t>(std::clamp<int32_t>(
+            v, std::numeric_limits<coord_t>::min(), LV_CHART_POINT_NONE - 1));
+    }
+
+  public:
+    stream_chart(object_ref parent,
+                 const std::array<lv_color_t, Series> &colors,
+                 update_mode mode = update_mode::shift)
+        : chart{parent} {
+        set_type(type::line);
+        set_point_count(static_cast<uint16_t>(Capacity));
+        set_update_mode(mode);
+
+        for (std::size_t i = 0; i < Series; i++) {
+            _buffers[i].fill(LV_CHART_POINT_NONE);
+            _series[i] = add_series(colors[i]);
+            lv_chart_set_ext_y_array(get_object(), get_series(_series[i]),
+                                     _buffers[i].data());
+        }
+    }
+
+    stream_chart(object_ref parent, lv_color_t color,
+                 update_mode mode = update_mode::shift)
+        : stream_chart{parent, std::array<lv_color_t, Series>{color}, mode} {}
+
+    // lv_chart keeps pointing at the series buffers
+    stream_chart(stream_chart &&) = delete;
+    stream_chart &operator=(stream_chart &&) = delete;
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    /**
+     * @brief Append samples to series `idx`.
+     *
+     * If more than `Capacity` samples are passed, only the most recent ones
+     * are kept. The redraw is requested once for the whole batch.
+     */
+    void push(std::size_t idx, std::span<const int32_t> samples) {
+        if (samples.empty())
+            return;
+
+        if (samples.size() > Capacity)
+            samples = samples.last(Capacity);
+
+        auto ser = get_series(_series[idx]);
+        auto &buf = _buffers[idx];
+        const std::size_t head = ser->start_point;
+        const std::size_t n = samples.size();
+
+        // write in at most two contiguous runs
+        const std::size_t first_run = std::min(n, Capacity - head);
+        std::transform(samples.begin(), samples.begin() + first_run,
+                       buf.begin() + head, clamp);
+        std::transform(samples.begin() + first_run, samples.end(),
+                       buf.begin(), clamp);
+
+        ser->start_point = static_cast<uint16_t>((head + n) % Capacity);
+
+        // in shift mode every point moves
+        if (_mode == update_mode::shift) {
+            lv_obj_invalidate(get_object());
+        } else if (head + n <= Capacity) {
+            invalidate_points(static_cast<uint16_t>(head),
+                              static_cast<uint16_t>(head + n - 1));
+        } else {
+            invalidate_points(static_cast<uint16_t>(head),
+                              static_cast<uint16_t>(Capacity - 1));
+            invalidate_points(0, static_cast<uint16_t>(head + n - 1 -
+                                                       Capacity));
+        }
+    }
+
+    void push(std::span<const int32_t> samples) { push(0, samples); }
+
+    void push(std::size_t idx, int32_t sample) {
+        push(idx, std::span<const int32_t>{&sample, 1});
+    }
+
+    /**
+     * @brief Drop all samples of every series.
+     */
+    void clear() {
+        for (std::size_t i = 0; i < Series; i++) {
+            _buffers[i].fill(LV_CHART_POINT_NONE);
+            get_series(_series[i])->start_point = 0;
+        }
+        lv_obj_invalidate(get_object());
+    }
+};
+
+enum class decimation { min_max, lttb };
+
+/**
+ * @brief Reduces a dense sample stream to a number of columns.
+ *
+ * Samples are kept in a ring of `Capacity` entries; each column covers
+ * `Capacity / columns()` consecutive samples. Columns are aligned to the
+ * absolute sample index, so pushing samples only recomputes the columns the
+ * new samples fall into (plus the one before for LTTB, whose choice depends
+ * on its right neighbour). The column count can change at runtime, e.g. with
+ * the width of a chart; the window is then recomputed from the held samples.
+ *
+ * - min_max: two points per column, the minimum and maximum of its samples.
+ *   Drawn as a line this covers exactly the pixels a full-resolution plot
+ *   would touch.
+ * - lttb: one point per column, chosen by the largest-triangle-three-buckets
+ *   rule. The newest column shows its latest sample until the next column
+ *   has data.
+ */
+template <std::size_t Capacity, decimation Mode = decimation::min_max>
+class decimator {
+  public:
+    static constexpr std::size_t points_per_column =
+        Mode == decimation::min_max ? 2 : 1;
+    /// lv_chart supports at most 65535 points per series
+    static constexpr std::size_t max_columns = std::min<std::size_t>(
+        Capacity, std::numeric_limits<uint16_t>::max() / points_per_column);
+
+    static_assert(Capacity >= 2, "decimator needs at least two samples");
+
+    /// absolute column indices, both inclusive
+    struct column_range {
+        uint64_t first;
+        uint64_t last;
+    };
+
+  private:
+    std::array<coord_t, Capacity> _samples;
+    std::vector<coord_t> _points;
+    /// lttb only: offset of the chosen sample inside its column
+    std::vector<uint32_t> _chosen;
+    std::size_t _columns = 0;
+    std::size_t _samples_per_column = 0;
+    uint64_t _total = 0;
+
+    static coord_t clamp(int32_t v) {
+        return static_cast<coord_t>(std::clamp<int32_t>(
+            v, std::numeric_limits<coord_t>::min(), LV_CHART_POINT_NONE - 1));
+    }
+
+    coord_t sample(uint64_t idx) const { return _samples[idx % Capacity]; }
+
+    /// first absolute sample index still held by the ring
+    uint64_t oldest_sample() const {
+        return _total > Capacity ? _total - Capacity : 0;
+    }
+
+    uint64_t column_begin(uint64_t col) const {
+        return std::max(col * _samples_per_column, oldest_sample());
+    }
+
+    uint64_t column_end(uint64_t col) const {
+        return std::min((col + 1) * _samples_per_column, _total);
+    }
+
+    uint64_t oldest_column(uint64_t last) const {
+        return last >= _columns ? last - (_columns - 1) : 0;
+    }
+
+    void compute(uint64_t col, uint64_t oldest_col) {
+        if constexpr (Mode == decimation::min_max)
+            compute_min_max(col);
+        else
+            compute_lttb(col, oldest_col);
+    }
+
+    void compute_min_max(uint64_t col) {
+        coord_t lo = std::numeric_limits<coord_t>::max();
+        coord_t hi = std::numeric_limits<coord_t>::min();
+
+        for (auto i = column_begin(col), e = column_end(col); i < e; i++) {
+            lo = std::min(lo, sample(i));
+            hi = std::max(hi, sample(i));
+        }
+
+        auto p = &_points[slot(col)];
+        p[0] = lo;
+        p[1] = hi;
+    }
+
+    void compute_lttb(uint64_t col, uint64_t oldest_col) {
+        const auto spc = _samples_per_column;
+        const auto begin = column_begin(col);
+        const auto end = column_end(col);
+        auto &chosen = _chosen[col % _columns];
+
+        // no right neighbour yet: keep the newest sample visible
+        if (end == _total) {
+            chosen = static_cast<uint32_t>(end - 1 - col * spc);
+            _points[slot(col)] = sample(end - 1);
+            return;
+        }
+
+        // left neighbour is the previously chosen point; the first column
+        // in the window has none and uses its own first sample instead
+        double ax = static_cast<double>(begin);
+        double ay = sample(begin);
+        if (col > oldest_col) {
+            const auto prev = col - 1;
+            ax = static_cast<double>(prev * spc + _chosen[prev % _columns]);
+            ay = _points[slot(prev)];
+        }
+
+        // right neighbour is the average of the next column
+        const auto nbegin = column_begin(col + 1);
+        const auto nend = column_end(col + 1);
+        double cy = 0;
+        for (auto i = nbegin; i < nend; i++)
+            cy += sample(i);
+        cy /= static_cast<double>(nend - nbegin);
+        const double cx = (nbegin + nend - 1) / 2.0;
+
+        double best_area = -1;
+        uint64_t best = begin;
+        for (auto i = begin; i < end; i++) {
+            const double area = std::abs((ax - cx) * (sample(i) - ay) -
+                                         (ax - double(i)) * (cy - ay));
+            if (area > best_area) {
+                best_area = area;
+                best = i;
+            }
+        }
+
+        chosen = static_cast<uint32_t>(best - col * spc);
+        _points[slot(col)] = sample(best);
+    }
+
+  public:
+    explicit decimator(std::size_t columns) { set_columns(columns); }
+
+    /**
+     * @brief Change the number of columns, clamped to [2, max_columns].
+     *
+     * Recomputes the whole window; the caller has to hand the new points()
+     * to lv_chart. Does nothing if the count doesn't change.
+     */
+    void set_columns(std::size_t columns) {
+        columns = std::clamp<std::size_t>(columns, 2, max_columns);
+        if (columns == _columns)
+            return;
+
+        _columns = columns;
+        _samples_per_column = Capacity / columns;
+        _points.assign(columns * points_per_column, LV_CHART_POINT_NONE);
+        if constexpr (Mode == decimation::lttb)
+            _chosen.assign(columns, 0);
+
+        if (_total == 0)
+            return;
+        const auto last = newest_column();
+        const auto oldest_col = oldest_column(last);
+        for (auto col = oldest_col; col <= last; col++)
+            compute(col, oldest_col);
+    }
+
+    std::size_t columns() const { return _columns; }
+
+    std::size_t point_count() const { return _points.size(); }
+
+    /// first point of column `col` in points()
+    std::size_t slot(uint64_t col) const {
+        return static_cast<std::size_t>(col % _columns) * points_per_column;
+    }
+
+    coord_t *points() { return _points.data(); }
+
+    const coord_t *points() const { return _points.data(); }
+
+    /// number of samples pushed so far
+    uint64_t total() const { return _total; }
+
+    /// column the latest sample falls into
+    uint64_t newest_column() const {
+        return _total ? (_total - 1) / _samples_per_column : 0;
+    }
+
+    /**
+     * @brief Append samples and recompute the affected columns.
+     *
+     * @return the columns whose points changed; `samples` must not be empty.
+     */
+    column_range push(std::span<const int32_t> samples) {
+        if (samples.size() > Capacity) {
+            _total += samples.size() - Capacity;
+            samples = samples.last(Capacity);
+        }
+
+        const auto first_new = _total / _samples_per_column;
+        const std::size_t head = _total % Capacity;
+        const std::size_t n = samples.size();
+        const std::size_t first_run = std::min(n, Capacity - head);
+
+        std::transform(samples.begin(), samples.begin() + first_run,
+                       _samples.begin() + head, clamp);
+        std::transform(samples.begin() + first_run, samples.end(),
+                       _samples.begin(), clamp);
+        _total += n;
+
+        const auto last = newest_column();
+        const auto oldest_col = oldest_column(last);
+        auto first = first_new;
+        if constexpr (Mode == decimation::lttb) {
+            if (first > 0)
+                first--;
+        }
+        first = std::max(first, oldest_col);
+
+        for (auto col = first; col <= last; col++)
+            compute(col, oldest_col);
+
+        return {first, last};
+    }
+};
+
+/**
+ * @brief Streaming chart that draws a decimated view of its samples.
+ *
+ * Holds `Capacity` samples but hands lv_chart only one column of points per
+ * pixel of its content width, so drawing cost follows the widget's width
+ * rather than the amount of data. The columns are recomputed whenever the
+ * size changes. While the newest column fills up only that column is
+ * redrawn; the plot scrolls once per completed column in shift mode.
+ */
+template <std::size_t Capacity, decimation Mode = decimation::min_max>
+class decimated_chart : public chart {
+    using decimator_type = decimator<Capacity, Mode>;
+
+    decimator_type _decimator{2};
+    series _series;
+
+    uint16_t point_count() const {
+        return static_cast<uint16_t>(_decimator.point_count());
+    }
+
+    /// slot of the oldest column in the window
+    uint16_t start_slot() const {
+        return static_cast<uint16_t>(
+            _decimator.slot(_decimator.newest_column() + 1));
+    }
+
+    void invalidate_columns(uint64_t first, uint64_t last,
+                            std::size_t origin) {
+        const auto cnt = point_count();
+        auto pos = [&](uint64_t col) {
+            return static_cast<uint16_t>(
+                (_decimator.slot(col) + cnt - origin) % cnt);
+        };
+        constexpr auto ppc = decimator_type::points_per_column;
+
+        const auto from = pos(first);
+        const auto to = static_cast<uint16_t>(pos(last) + ppc - 1);
+        if (from <= to) {
+            invalidate_points(from, to);
+        } else {
+            invalidate_points(from, cnt - 1);
+            invalidate_points(0, to);
+        }
+    }
+
+    /// hand the decimator's current points to lv_chart
+    void use_points() {
+        auto ser = get_series(_series);
+        set_point_count(point_count());
+        lv_chart_set_ext_y_array(get_object(), ser, _decimator.points());
+        ser->start_point = start_slot();
+        lv_obj_invalidate(get_object());
+    }
+
+    /// one column per pixel of the content width
+    void fit_columns() {
+        const auto columns = _decimator.columns();
+        _decimator.set_columns(static_cast<std::size_t>(
+            std::max<coord_t>(lv_obj_get_content_width(get_object()), 0)));
+        if (_decimator.columns() != columns)
+            use_points();
+    }
+
+    static void on_size_changed(lv_event_t *ev) {
+        static_cast<decimated_chart *>(lv_event_get_user_data(ev))
+            ->fit_columns();
+    }
+
+  public:
+    decimated_chart(object_ref parent, lv_color_t color,
+                    update_mode mode = update_mode::shift)
+        : chart{parent} {
+        set_type(type::line);
+        set_update_mode(mode);
+        _series = add_series(color);
+        fit_columns();
+        use_points();
+
+        mem::scope s{get_object()};
+        lv_obj_add_event_cb(get_object(), on_size_changed,
+                            LV_EVENT_SIZE_CHANGED, this);
+    }
+
+    // lv_chart keeps pointing at the decimator's points, and the size
+    // handler at the chart
+    decimated_chart(decimated_chart &&) = delete;
+    decimated_chart &operator=(decimated_chart &&) = delete;
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    std::size_t columns() const { return _decimator.columns(); }
+
+    void push(std::span<const int32_t> samples) {
+        if (samples.empty())
+            return;
+
+        const auto range = _decimator.push(samples);
+        auto ser = get_series(_series);
+
+        // the column after the newest one is the oldest in the window
+        const auto start = start_slot();
+
+        if (_mode == update_mode::shift) {
+            if (ser->start_point != start) {
+                ser->start_point = start;
+                lv_obj_invalidate(get_object());
+            } else {
+                invalidate_columns(range.first, range.last, start);
+            }
+        } else {
+            ser->start_point = start;
+            invalidate_columns(range.first, range.last, 0);
+        }
+    }
+
+    void push(int32_t sample) { push(std::span<const int32_t>{&sample, 1}); }
+};
+
+} // namespace lvgl
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "lvgl.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+
+namespace lvgl {
+
+/**
+ * @brief Fire-and-forget coroutine running on the LVGL thread.
+ *
+ * Starts immediately and frees itself when it completes. Suspension points
+ * are the awaitables below, which resume the coroutine from
+ * lv_timer_handler().
+ *
+ * @code
+ * lvgl::task blink(lvgl::led &led) {
+ *     for (int i = 0; i < 3; i++) {
+ *         led.on();
+ *         co_await lvgl::sleep_for(200ms);
+ *         led.off();
+ *         co_await lvgl::sleep_for(200ms);
+ *     }
+ * }
+ * @endcode
+ */
+class task {
+  public:
+    struct promise_type {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+namespace detail {
+
+/// waiting coroutine; lives in the coroutine frame, so waiting never
+/// allocates
+struct sleeper {
+    uint32_t deadline;
+    std::coroutine_handle<> handle;
+    sleeper *next = nullptr;
+};
+
+/**
+ * @brief Resumes sleeping coroutines from a single LVGL timer.
+ *
+ * Sleepers are kept in a list sorted by deadline; the timer is re-armed for
+ * the earliest one and paused while nobody waits.
+ */
+class coro_scheduler {
+    lv_timer_t *_timer = nullptr;
+    sleeper *_head = nullptr;
+
+    static bool due(uint32_t deadline, uint32_t now) {
+        return static_cast<int32_t>(deadline - now) <= 0;
+    }
+
+    void arm(uint32_t now) {
+        if (!_head) {
+            lv_timer_pause(_timer);
+            return;
+        }
+
+        const auto wait = due(_head->deadline, now) ? 0 : _head->deadline - now;
+        lv_timer_set_period(_timer, wait);
+        lv_timer_reset(_timer);
+        lv_timer_resume(_timer);
+    }
+
+    static void run(lv_timer_t *t) {
+        auto self = static_cast<coro_scheduler *>(t->user_data);
+        const auto now = lv_tick_get();
+
+        // detach everything that is due first, resumed coroutines may
+        // enqueue themselves again
+        sleeper *ready = nullptr;
+        sleeper **tail = &ready;
+        while (self->_head && due(self->_head->deadline, now)) {
+            *tail = self->_head;
+            tail = &self->_head->next;
+            self->_head = self->_head->next;
+        }
+        *tail = nullptr;
+
+        while (ready) {
+            auto s = ready;
+            ready = ready->next;
+            // may destroy the frame holding `s`
+            s->handle.resume();
+        }
+
+        self->arm(lv_tick_get());
+    }
+
+  public:
+    static coro_scheduler &get() {
+        static coro_scheduler sched;
+        return sched;
+    }
+
+    void add(sleeper *s) {
+        if (!_timer)
+            _timer = lv_timer_create(run, 0, this);
+
+        auto pos = &_head;
+        while (*pos && !due(s->deadline, (*pos)->deadline))
+            pos = &(*pos)->next;
+        s->next = *pos;
+        *pos = s;
+
+        arm(lv_tick_get());
+    }
+};
+
+class sleep_awaiter : sleeper {
+    uint32_t _ms;
+
+  public:
+    explicit sleep_awaiter(uint32_t ms) : _ms{ms} {}
+
+    // even a zero wait yields to the next lv_timer_handler() run
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        deadline = lv_tick_get() + _ms;
+        handle = h;
+        coro_scheduler::get().add(this);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+/**
+ * @brief Suspend the current coroutine for `d`.
+ */
+template <typename Rep, typename Period>
+auto sleep_for(std::chrono::duration<Rep, Period> d) {
+    return detail::sleep_awaiter{static_cast<uint32_t>(
+        std::chrono::ceil<std::chrono::milliseconds>(d).count())};
+}
+
+/**
+ * @brief Suspend the current coroutine until the default display has had
+ * the chance to refresh.
+ *
+ * Waits one refresh period of the default display, so changes made before
+ * the co_await are on screen when the coroutine continues.
+ */
+inline auto next_frame() {
+    uint32_t period = LV_DISP_DEF_REFR_PERIOD;
+    if (auto disp = lv_disp_get_default()) {
+        if (auto refr = _lv_disp_get_refr_timer(disp))
+            period = refr->period;
+    }
+    return detail::sleep_awaiter{period};
+}
+
+} // namespace lvgl
@@ -1,11 +1,21 @@
 #pragma once
 
+#include "lvgl_rotate.hpp"
+#include "lvgl_scale.hpp"
+#include "lvgl_trace.hpp"
 #include <array>
+#include <concepts>
+#include <cstring>
+#include <memory>
 
 namespace lvgl {
 
 class theme;
 
+namespace redraw {
+class monitor;
+}
+
 namespace drivers {
 
 template <typename Buffer> class draw_buffer {
@@ -26,21 +36,33 @@ template <typename Buffer> class draw_buffer {
     auto height() const { return static_cast<const Buffer *>(this)->height(); }
 };
 
-template <lv_coord_t Width, lv_coord_t Height>
+/**
+ * @brief `Count` statically allocated draw buffers of `Width * Height` pixels.
+ *
+ * Screen-sized buffers can be used for full refresh and direct mode, see
+ * display_traits.
+ */
+template <lv_coord_t Width, lv_coord_t Height, int Count = 1>
 class static_buffer
-    : public lvgl::drivers::draw_buffer<static_buffer<Width, Height>> {
+    : public lvgl::drivers::draw_buffer<static_buffer<Width, Height, Count>> {
+
+    static_assert(Count == 1 || Count == 2,
+                  "LVGL supports one or two draw buffers");
 
   private:
-    std::array<lv_color_t, Width * Height> _buffer;
+    std::array<std::array<lv_color_t, Width * Height>, Count> _buffer;
 
   public:
+    static constexpr int buffer_count = Count;
+    static constexpr std::size_t buffer_size = Width * Height;
+
     auto width() const { return Width; }
 
     auto height() const { return Height; }
 
     lv_color_t *get_buffer(int idx) {
-        if (idx == 0)
-            return &_buffer[0];
+        if (idx < Count)
+            return _buffer[idx].data();
 
         return nullptr;
     }
@@ -48,43 +70,298 @@ class static_buffer
     auto get_buffer_size() const { return Width * Height; }
 };
 
+/**
+ * @brief Handle to a registered display.
+ *
+ * Any number of displays can be registered, each with its own driver, draw
+ * buffer, refresh timer and theme. New screens (and input devices registered
+ * without a display) belong to the default display, see set_default().
+ */
 class display {
     friend class display_driver_base;
+    friend class lvgl::redraw::monitor;
     lv_disp_t *_disp;
 
     display(lv_disp_t *disp) : _disp{disp} {}
 
   public:
-    void apply_theme(lvgl::theme t) { lv_disp_set_theme(_disp, t._theme); }
+    void apply_theme(const lvgl::theme &t) {
+        lv_disp_set_theme(_disp, t._theme);
+    }
+
+    object_ref get_top_layer() {
+        return object_ref{lv_disp_get_layer_top(_disp)};
+    }
 
-    auto get_top_layer() { return non_owning_wrapper<object>{lv_layer_top()}; }
+    object_ref get_sys_layer() {
+        return object_ref{lv_disp_get_layer_sys(_disp)};
+    }
+
+    void set_default() { lv_disp_set_default(_disp); }
+
+    bool is_default() const { return lv_disp_get_default() == _disp; }
 
-    auto get_sys_layer() { return non_owning_wrapper<object>{lv_layer_sys()}; }
+    /**
+     * @brief Set how often the display checks for invalidated areas.
+     *
+     * Every display has its own refresh timer, so a status panel can refresh
+     * less often than the main panel.
+     */
+    void set_refresh_period(uint32_t period) {
+        lv_timer_set_period(_lv_disp_get_refr_timer(_disp), period);
+    }
+
+    uint32_t get_refresh_period() const {
+        return _lv_disp_get_refr_timer(_disp)->period;
+    }
+
+    /**
+     * @brief Redraw the invalidated areas right away.
+     */
+    void refresh_now() { lv_refr_now(_disp); }
+
+    bool operator==(const display &other) const {
+        return _disp == other._disp;
+    }
 };
 
-template <typename T>
-concept DisplayDriver = requires(T &o, const lvgl::area_t &area,
-                                 lvgl::color_t *color_p) {
-    {o.flush_display(area, color_p)};
+/**
+ * @brief Rotation applied between LVGL's drawing and the panel.
+ *
+ * Matches LV_DISP_ROT_*; the resolution of a driver stays the physical
+ * resolution of the panel.
+ */
+enum class rotation {
+    none = LV_DISP_ROT_NONE,
+    deg90 = LV_DISP_ROT_90,
+    deg180 = LV_DISP_ROT_180,
+    deg270 = LV_DISP_ROT_270
+};
+
+/**
+ * @brief Compile-time configuration of a display driver `T`.
+ *
+ * Every trait is an optional `static constexpr` member of `T`:
+ *
+ * | member          | default             |                                 |
+ * |-----------------|---------------------|---------------------------------|
+ * | `hor_res`       | `get_x_res()`       | physical resolution             |
+ * | `ver_res`       | `get_y_res()`       |                                 |
+ * | `color_depth`   | `LV_COLOR_DEPTH`    | must match lv_conf.h            |
+ * | `rotation`      | set at runtime      | fixes the rotation              |
+ * | `full_refresh`  | `false`             | always redraw the whole screen  |
+ * | `direct_mode`   | `false`             | draw buffer is the framebuffer  |
+ * | `buffer_count`  | any                 | draw buffers the driver expects |
+ * | `antialiasing`  | `true`              |                                 |
+ *
+ * In direct mode LVGL renders straight into screen-sized draw buffers and
+ * flush_display() gets the whole buffer (row stride `hor_res`) once per
+ * redrawn area; a driver presents it on flush_is_last(). With two buffers
+ * the redrawn areas are copied to the other one before that last flush, so
+ * both always hold the complete frame and can be scanned out as they are.
+ */
+template <typename T> struct display_traits {
+    static constexpr bool static_resolution = requires {
+        T::hor_res;
+        T::ver_res;
+    };
+
+    static constexpr int color_depth = [] {
+        if constexpr (requires { T::color_depth; })
+            return static_cast<int>(T::color_depth);
+        else
+            return LV_COLOR_DEPTH;
+    }();
+
+    static constexpr bool fixed_rotation = requires { T::rotation; };
+
+    static constexpr drivers::rotation rotation = [] {
+        if constexpr (fixed_rotation)
+            return static_cast<drivers::rotation>(T::rotation);
+        else
+            return drivers::rotation::none;
+    }();
+
+    static constexpr bool full_refresh = [] {
+        if constexpr (requires { T::full_refresh; })
+            return static_cast<bool>(T::full_refresh);
+        else
+            return false;
+    }();
+
+    static constexpr bool direct_mode = [] {
+        if constexpr (requires { T::direct_mode; })
+            return static_cast<bool>(T::direct_mode);
+        else
+            return false;
+    }();
+
+    /// 0 if the driver accepts any number of draw buffers
+    static constexpr int buffer_count = [] {
+        if constexpr (requires { T::buffer_count; })
+            return static_cast<int>(T::buffer_count);
+        else
+            return 0;
+    }();
+
+    static constexpr bool antialiasing = [] {
+        if constexpr (requires { T::antialiasing; })
+            return static_cast<bool>(T::antialiasing);
+        else
+            return true;
+    }();
 };
 
+template <typename T>
+concept DisplayDriver =
+    requires(T &o, const lvgl::area_t &area, lvgl::color_t *color_p) {
+        {o.flush_display(area, color_p)};
+    } &&
+    (display_traits<T>::static_resolution || requires(const T &o) {
+        {o.get_x_res()} -> std::convertible_to<lv_coord_t>;
+        {o.get_y_res()} -> std::convertible_to<lv_coord_t>;
+    });
+
 class display_driver_base {
   protected:
     lv_disp_drv_t _driver;
     lv_disp_t *_disp;
 
+    /// receives rotated pixels, allocated once a rotation is set
+    std::unique_ptr<lv_color_t[]> _rotated;
+    std::unique_ptr<scale::scaler> _scaler;
+
     template <typename Buffer>
-    display_driver_base(draw_buffer<Buffer> &buffer) {
+    display_driver_base(draw_buffer<Buffer> &buffer, rotation rot) {
         lv_disp_drv_init(&_driver);
         _driver.draw_buf = &buffer._draw_buffer;
+        set_rotation_buffer(rot);
+        _driver.rotated = static_cast<lv_disp_rot_t>(rot);
+        // rotated in flush(), not by LVGL's per-pixel loop
+        _driver.sw_rotate = 0;
+    }
+
+    void set_rotation_buffer(rotation rot) {
+        if (rot != rotation::none && !_rotated)
+            _rotated = std::make_unique<lv_color_t[]>(_driver.draw_buf->size);
+    }
+
+    /**
+     * @brief Rotate `color_p` into the rotation buffer and map `area` to
+     * panel coordinates.
+     */
+    lv_color_t *apply_rotation(lvgl::area_t &area, const lv_color_t *color_p,
+                               rotation rot) {
+        const auto w = area.get_width();
+        const auto h = area.get_height();
+        const lv_coord_t hor = _driver.hor_res;
+        const lv_coord_t ver = _driver.ver_res;
+        const auto a = area;
+
+        switch (rot) {
+        case rotation::deg90:
+            rotate::rotate_90(color_p, w, h, _rotated.get());
+            area = {a.y1, static_cast<coord_t>(ver - 1 - a.x2), a.y2,
+                    static_cast<coord_t>(ver - 1 - a.x1)};
+            break;
+        case rotation::deg180:
+            rotate::rotate_180(color_p, w, h, _rotated.get());
+            area = {static_cast<coord_t>(hor - 1 - a.x2),
+                    static_cast<coord_t>(ver - 1 - a.y2),
+                    static_cast<coord_t>(hor - 1 - a.x1),
+                    static_cast<coord_t>(ver - 1 - a.y1)};
+            break;
+        case rotation::deg270:
+            rotate::rotate_270(color_p, w, h, _rotated.get());
+            area = {static_cast<coord_t>(hor - 1 - a.y2), a.x1,
+                    static_cast<coord_t>(hor - 1 - a.y1), a.x2};
+            break;
+        default:
+            return const_cast<lv_color_t *>(color_p);
+        }
+
+        return _rotated.get();
+    }
+
+    /**
+     * @brief Copy the areas redrawn into `drawn` to the other buffer.
+     *
+     * In direct mode LVGL only redraws the invalidated areas, so with two
+     * buffers the next back buffer has to catch up on what changed in the
+     * frame that is about to be shown. Called for the last flush of a
+     * refresh, when the invalidated areas are still recorded.
+     */
+    void sync_direct_buffers(const lv_color_t *drawn) {
+        const auto buf = _driver.draw_buf;
+        if (!buf->buf1 || !buf->buf2)
+            return;
+
+        auto other = static_cast<lv_color_t *>(
+            drawn == buf->buf1 ? buf->buf2 : buf->buf1);
+        const auto stride = _driver.hor_res;
+
+        for (uint16_t i = 0; i < _disp->inv_p; i++) {
+            if (_disp->inv_area_joined[i])
+                continue;
+
+            const auto &a = _disp->inv_areas[i];
+            const auto bytes = lv_area_get_width(&a) * sizeof(lv_color_t);
+            for (lv_coord_t y = a.y1; y <= a.y2; y++) {
+                const auto ofs = y * stride + a.x1;
+                std::memcpy(other + ofs, drawn + ofs, bytes);
+            }
+        }
     }
 
   public:
     display get_display() { return display{_disp}; }
+
+    /**
+     * @brief Change the rotation; the screen is redrawn completely.
+     */
+    void set_rotation(rotation rot) {
+        set_rotation_buffer(rot);
+        lv_disp_set_rotation(_disp, static_cast<lv_disp_rot_t>(rot));
+    }
+
+    rotation get_rotation() const {
+        return static_cast<rotation>(_driver.rotated);
+    }
+
+    /**
+     * @brief Scale the rendered frame to `output` before flushing.
+     *
+     * LVGL keeps rendering at the resolution reported by the driver;
+     * flush_display() receives areas in `output` coordinates. Pointer
+     * drivers translate back with to_native().
+     */
+    void set_scaling(lvgl::size output) {
+        if (output.width == _driver.hor_res &&
+            output.height == _driver.ver_res) {
+            _scaler.reset();
+            return;
+        }
+
+        _scaler = std::make_unique<scale::scaler>(
+            _driver.hor_res, _driver.ver_res, output.width, output.height);
+
+        // the bilinear scaler needs a complete frame in its shadow buffer
+        lv_obj_invalidate(lv_disp_get_scr_act(_disp));
+    }
+
+    /**
+     * @brief Map panel coordinates, e.g. of a touch, to LVGL's resolution.
+     */
+    void to_native(coord_t &x, coord_t &y) const {
+        if (_scaler)
+            _scaler->to_native(x, y);
+    }
 };
 
 template <typename T> class display_driver : public display_driver_base {
 
+    using traits = display_traits<T>;
+
     auto &get() { return *static_cast<T *>(this); }
 
     static void flush(lv_disp_drv_t *disp_drv, const lv_area_t *area,
@@ -96,8 +373,70 @@ template <typename T> class display_driver : public display_driver_base {
                       "display_driver<T> must be a standard-layout type");
         auto self = reinterpret_cast<display_driver<T> *>(disp_drv);
 #endif
-        self->get().flush_display(
-            lvgl::area_t{area->x1, area->y1, area->x2, area->y2}, color_p);
+        LVGL_TRACE_SCOPE("flush");
+        lvgl::area_t a{area->x1, area->y1, area->x2, area->y2};
+
+        if constexpr (traits::direct_mode) {
+            // pixels stay where LVGL drew them; `color_p` is the framebuffer
+            if (lv_disp_flush_is_last(disp_drv))
+                self->sync_direct_buffers(color_p);
+        } else if constexpr (traits::fixed_rotation) {
+            if constexpr (traits::rotation != rotation::none)
+                color_p = self->apply_rotation(a, color_p, traits::rotation);
+        } else if (disp_drv->rotated != LV_DISP_ROT_NONE) {
+            color_p = self->apply_rotation(
+                a, color_p, static_cast<rotation>(disp_drv->rotated));
+        }
+
+        if constexpr (!traits::direct_mode) {
+            if (self->_scaler)
+                color_p = self->_scaler->scale(a, color_p);
+        }
+
+        self->get().flush_display(a, color_p);
+    }
+
+    static constexpr lv_coord_t static_hor_res() {
+        if constexpr (traits::static_resolution)
+            return T::hor_res;
+        else
+            return 0;
+    }
+
+    static constexpr lv_coord_t static_ver_res() {
+        if constexpr (traits::static_resolution)
+            return T::ver_res;
+        else
+            return 0;
+    }
+
+    template <typename Buffer> static constexpr void validate() {
+        static_assert(DisplayDriver<T>,
+                      "T must implement flush_display() and provide its "
+                      "resolution");
+        static_assert(traits::color_depth == LV_COLOR_DEPTH,
+                      "the driver's color depth does not match LV_COLOR_DEPTH");
+        static_assert(traits::buffer_count >= 0 && traits::buffer_count <= 2,
+                      "LVGL supports one or two draw buffers");
+        static_assert(!traits::direct_mode ||
+                          traits::rotation == rotation::none,
+                      "direct mode cannot be combined with rotation");
+
+        if constexpr (requires { Buffer::buffer_count; }) {
+            static_assert(traits::buffer_count == 0 ||
+                              Buffer::buffer_count == traits::buffer_count,
+                          "the draw buffer has the wrong number of buffers");
+        }
+
+        if constexpr (traits::static_resolution &&
+                      requires { Buffer::buffer_size; }) {
+            static_assert(!(traits::full_refresh || traits::direct_mode) ||
+                              Buffer::buffer_size >=
+                                  std::size_t(static_hor_res()) *
+                                      static_ver_res(),
+                          "full refresh and direct mode need screen-sized "
+                          "draw buffers");
+        }
     }
 
   protected:
@@ -106,20 +445,59 @@ template <typename T> class display_driver : public display_driver_base {
     bool flush_is_last() { return lv_disp_flush_is_last(&_driver); }
 
   public:
+    /**
+     * @param rot  rotation done in the flush path with a cache-blocked
+     *             transpose; flush_display() always receives panel
+     *             coordinates. Ignored, with a warning, if `T` fixes the
+     *             rotation or uses direct mode.
+     */
     template <typename Buffer>
-    display_driver(draw_buffer<Buffer> &buffer) : display_driver_base{buffer} {
+    display_driver(draw_buffer<Buffer> &buffer, rotation rot = rotation::none)
+        : display_driver_base{buffer, traits::fixed_rotation ? traits::rotation
+                                      : traits::direct_mode  ? rotation::none
+                                                             : rot} {
+        validate<Buffer>();
+        if ((traits::fixed_rotation || traits::direct_mode) &&
+            rot != rotation::none && rot != traits::rotation) {
+            LV_LOG_WARN("rotation ignored, the driver fixes it or draws in "
+                        "direct mode");
+        }
 
         _driver.flush_cb = display_driver<T>::flush; // monitor_flush;
-        _driver.hor_res = get().get_x_res();         // SDL_HOR_RES;
-        _driver.ver_res = get().get_y_res();         // SDL_VER_RES;
-        _driver.antialiasing = 1;
-        _driver.full_refresh = 0;
+        if constexpr (traits::static_resolution) {
+            _driver.hor_res = T::hor_res;
+            _driver.ver_res = T::ver_res;
+        } else {
+            _driver.hor_res = get().get_x_res(); // SDL_HOR_RES;
+            _driver.ver_res = get().get_y_res(); // SDL_VER_RES;
+        }
+        _driver.antialiasing = traits::antialiasing;
+        _driver.full_refresh = traits::full_refresh;
+        _driver.direct_mode = traits::direct_mode;
 
 #if LV_USE_USER_DATA
         _driver.user_data = this;
 #endif
 
         _disp = lv_disp_drv_register(&_driver);
+#ifdef LVGL_TRACE
+        // the refresh timer renders and flushes the invalidated areas
+        lv_timer_set_cb(_disp->refr_timer, [](lv_timer_t *t) {
+            LVGL_TRACE_SCOPE("refresh");
+            _lv_disp_refr_timer(t);
+        });
+#endif
+    }
+
+    /**
+     * @brief Change the rotation; not for drivers with a fixed one or in
+     * direct mode.
+     */
+    void set_rotation(rotation rot)
+        requires(!display_traits<T>::fixed_rotation &&
+                 !display_traits<T>::direct_mode)
+    {
+        display_driver_base::set_rotation(rot);
     }
 };
 
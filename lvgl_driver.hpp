@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lvgl.h"
+#include "lvgl_trace.hpp"
 
 namespace lvgl {
 
@@ -9,10 +10,31 @@ class group;
 namespace drivers {
 
 class input_driver_base {
+  public:
+    /// called with every state read from the device
+    using read_observer = void (*)(void *ctx, const lv_indev_drv_t &drv,
+                                   const lv_indev_data_t &data);
+
+    /**
+     * @brief Observe the device's reads, e.g. to record them; `nullptr`
+     * removes the observer.
+     */
+    void set_read_observer(read_observer fn, void *ctx) {
+        _observer = fn;
+        _observer_ctx = ctx;
+    }
+
   protected:
     friend class group;
     lv_indev_drv_t _driver;
     lv_indev_t *_dev;
+    read_observer _observer = nullptr;
+    void *_observer_ctx = nullptr;
+
+    void notify(const lv_indev_data_t *data) {
+        if (_observer)
+            _observer(_observer_ctx, _driver, *data);
+    }
 };
 
 class keyboard_input_driver_base : public input_driver_base {
@@ -26,6 +48,7 @@ template <typename T> class input_pointer_driver : public input_driver_base {
 
     static void read_callback(lv_indev_drv_t *indev_drv,
                               lv_indev_data_t *data) {
+        LVGL_TRACE_SCOPE("indev_read");
 
 #if LV_USE_USER_DATA
         auto drv =
@@ -35,12 +58,17 @@ template <typename T> class input_pointer_driver : public input_driver_base {
         auto drv = reinterpret_cast<input_pointer_driver<T> *>(indev_drv);
 #endif
         drv->get().get_pointer_state(data->point.x, data->point.y, data->state);
+        drv->notify(data);
     }
 
   public:
-    input_pointer_driver() {
+    /**
+     * @param disp  display the pointer acts on, nullptr for the default one
+     */
+    explicit input_pointer_driver(lv_disp_t *disp = nullptr) {
         lv_indev_drv_init(&_driver);
         _driver.type = LV_INDEV_TYPE_POINTER;
+        _driver.disp = disp;
         _driver.read_cb = input_pointer_driver::read_callback;
 #if LV_USE_USER_DATA
         _driver.user_data = this;
@@ -57,6 +85,7 @@ class input_keyboard_driver : public keyboard_input_driver_base {
 
     static void read_callback(lv_indev_drv_t *indev_drv,
                               lv_indev_data_t *data) {
+        LVGL_TRACE_SCOPE("indev_read");
 
 #if LV_USE_USER_DATA
         auto drv =
@@ -67,12 +96,17 @@ class input_keyboard_driver : public keyboard_input_driver_base {
 #endif
         data->continue_reading =
             drv->get().get_keyboard_state(data->key, data->state);
+        drv->notify(data);
     }
 
   public:
-    input_keyboard_driver() {
+    /**
+     * @param disp  display the keyboard acts on, nullptr for the default one
+     */
+    explicit input_keyboard_driver(lv_disp_t *disp = nullptr) {
         lv_indev_drv_init(&_driver);
         _driver.type = LV_INDEV_TYPE_KEYPAD;
+        _driver.disp = disp;
         _driver.read_cb = input_keyboard_driver::read_callback;
 
 #if LV_USE_USER_DATA
@@ -83,6 +117,45 @@ class input_keyboard_driver : public keyboard_input_driver_base {
     }
 };
 
+template <typename T>
+class input_encoder_driver : public keyboard_input_driver_base {
+
+    auto &get() { return *static_cast<T *>(this); }
+
+    static void read_callback(lv_indev_drv_t *indev_drv,
+                              lv_indev_data_t *data) {
+        LVGL_TRACE_SCOPE("indev_read");
+
+#if LV_USE_USER_DATA
+        auto drv =
+            reinterpret_cast<input_encoder_driver<T> *>(indev_drv->user_data);
+#else
+        static_assert(std::is_standard_layout_v<input_encoder_driver<T>>, "");
+        auto drv = reinterpret_cast<input_encoder_driver<T> *>(indev_drv);
+#endif
+        data->continue_reading =
+            drv->get().get_encoder_state(data->enc_diff, data->state);
+        drv->notify(data);
+    }
+
+  public:
+    /**
+     * @param disp  display the encoder acts on, nullptr for the default one
+     */
+    explicit input_encoder_driver(lv_disp_t *disp = nullptr) {
+        lv_indev_drv_init(&_driver);
+        _driver.type = LV_INDEV_TYPE_ENCODER;
+        _driver.disp = disp;
+        _driver.read_cb = input_encoder_driver::read_callback;
+
+#if LV_USE_USER_DATA
+        _driver.user_data = this;
+#endif
+
+        _dev = lv_indev_drv_register(&_driver);
+    }
+};
+
 class group {
     lv_group_t *_group;
 
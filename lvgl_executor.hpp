@@ -0,0 +1,203 @@
+#pragma once
+
+#include "lvgl_coro.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Moving work between the LVGL thread and background threads.
+ *
+ * A coroutine (see lvgl::task) hops to a worker with
+ * `co_await pool.schedule()` and back with `co_await lvgl::resume_on_ui()`:
+ *
+ * @code
+ * lvgl::task load(lvgl::label &lbl, std::string path) {
+ *     co_await lvgl::thread_pool::background().schedule();
+ *     auto text = read_and_format(path); // off the UI thread
+ *     co_await lvgl::resume_on_ui();
+ *     lbl.set_text(text.c_str());        // LVGL calls are safe again
+ * }
+ * @endcode
+ *
+ * The run loop has to call lvgl::ui_queue::drain() next to
+ * lv_timer_handler().
+ */
+namespace lvgl {
+
+/**
+ * @brief Coroutines waiting to continue on the LVGL thread.
+ *
+ * Multi-producer, single-consumer and lock-free: producers push onto an
+ * intrusive stack, the LVGL thread takes the whole stack at once and resumes
+ * it in push order.
+ */
+class ui_queue {
+  public:
+    struct node {
+        std::coroutine_handle<> handle;
+        node *next = nullptr;
+    };
+
+  private:
+    static std::atomic<node *> &head() {
+        static std::atomic<node *> _head{nullptr};
+        return _head;
+    }
+
+  public:
+    /**
+     * @brief Queue `n` for the LVGL thread; may be called from any thread.
+     */
+    static void push(node *n) {
+        auto &h = head();
+        n->next = h.load(std::memory_order_relaxed);
+        while (!h.compare_exchange_weak(n->next, n, std::memory_order_release,
+                                        std::memory_order_relaxed))
+            ;
+    }
+
+    /**
+     * @brief Resume all queued coroutines; call from the LVGL thread only.
+     *
+     * @return the number of coroutines resumed
+     */
+    static std::size_t drain() {
+        auto n = head().exchange(nullptr, std::memory_order_acquire);
+        if (!n)
+            return 0;
+
+        // the stack holds the newest entry first
+        node *fifo = nullptr;
+        while (n) {
+            auto next = n->next;
+            n->next = fifo;
+            fifo = n;
+            n = next;
+        }
+
+        std::size_t count = 0;
+        while (fifo) {
+            auto cur = fifo;
+            fifo = fifo->next;
+            // the node lives in the coroutine frame and is gone after this
+            cur->handle.resume();
+            count++;
+        }
+        return count;
+    }
+};
+
+namespace detail {
+
+class ui_awaiter : ui_queue::node {
+  public:
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        ui_queue::push(this);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+/**
+ * @brief Continue the current coroutine on the LVGL thread.
+ */
+inline auto resume_on_ui() { return detail::ui_awaiter{}; }
+
+/**
+ * @brief Fixed set of worker threads running coroutines.
+ */
+class thread_pool {
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::deque<std::coroutine_handle<>> _queue;
+    std::vector<std::thread> _workers;
+    bool _stop = false;
+
+    void run() {
+        for (;;) {
+            std::coroutine_handle<> h;
+            {
+                std::unique_lock lock{_mtx};
+                _cv.wait(lock, [this] { return _stop || !_queue.empty(); });
+                if (_queue.empty())
+                    return;
+                h = _queue.front();
+                _queue.pop_front();
+            }
+            h.resume();
+        }
+    }
+
+    void post(std::coroutine_handle<> h) {
+        {
+            std::lock_guard lock{_mtx};
+            _queue.push_back(h);
+        }
+        _cv.notify_one();
+    }
+
+    class schedule_awaiter {
+        thread_pool &_pool;
+
+      public:
+        explicit schedule_awaiter(thread_pool &pool) : _pool{pool} {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> h) { _pool.post(h); }
+
+        void await_resume() const noexcept {}
+    };
+
+  public:
+    explicit thread_pool(
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+        _workers.reserve(threads);
+        for (unsigned i = 0; i < threads; i++)
+            _workers.emplace_back([this] { run(); });
+    }
+
+    /**
+     * @brief Finishes the queued coroutines, then joins the workers.
+     */
+    ~thread_pool() {
+        {
+            std::lock_guard lock{_mtx};
+            _stop = true;
+        }
+        _cv.notify_all();
+        for (auto &w : _workers)
+            w.join();
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /**
+     * @brief Continue the current coroutine on one of the workers.
+     */
+    auto schedule() { return schedule_awaiter{*this}; }
+
+    auto size() const { return _workers.size(); }
+
+    /**
+     * @brief Pool shared by the application, created on first use.
+     */
+    static thread_pool &background() {
+        static thread_pool pool;
+        return pool;
+    }
+};
+
+} // namespace lvgl
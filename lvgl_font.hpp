@@ -0,0 +1,541 @@
+#pragma once
+
+#include "lvgl.h"
+#include "lvgl_mmap.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * Glyph bitmap caching for compressed fonts.
+ *
+ * With LV_USE_FONT_COMPRESSED, lv_font_fmt_txt decompresses a glyph every
+ * time it is drawn. A `cached_font` wraps such a font and serves its glyph
+ * bitmaps from a process-wide LRU `glyph_cache` with a memory budget, so
+ * static text is decompressed once. Glyph descriptors (metrics, kerning)
+ * are still taken from the wrapped font.
+ *
+ * A `binary_font` loads a font converted with `lv_font_conv --format bin`
+ * at runtime instead of compiling it in.
+ */
+namespace lvgl {
+
+/**
+ * @brief LRU cache of decoded glyph bitmaps, keyed by font and code point.
+ *
+ * A font is one typeface at one size, so the key also covers the size.
+ * Bitmaps handed out stay valid until the next insert(), which is all the
+ * glyph renderer needs; like LVGL, the cache is only used from the thread
+ * running lv_timer_handler().
+ */
+class glyph_cache {
+    struct key {
+        const lv_font_t *font;
+        uint32_t letter;
+
+        bool operator==(const key &) const = default;
+    };
+
+    struct key_hash {
+        std::size_t operator()(const key &k) const {
+            return std::hash<const void *>{}(k.font) ^
+                   (std::size_t{k.letter} * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    struct glyph {
+        key k;
+        std::size_t size;
+        std::unique_ptr<uint8_t[]> bitmap;
+    };
+
+    std::list<glyph> _lru; // most recently used first
+    std::unordered_map<key, std::list<glyph>::iterator, key_hash> _index;
+    std::size_t _budget = 64 * 1024;
+    std::size_t _bytes = 0;
+    uint64_t _hits = 0;
+    uint64_t _misses = 0;
+
+    void evict(std::size_t budget) {
+        while (_bytes > budget && !_lru.empty()) {
+            _bytes -= _lru.back().size;
+            _index.erase(_lru.back().k);
+            _lru.pop_back();
+        }
+    }
+
+  public:
+    struct stats {
+        uint64_t hits;
+        uint64_t misses;
+        std::size_t bytes;
+        std::size_t glyphs;
+    };
+
+    static glyph_cache &get() {
+        static glyph_cache cache;
+        return cache;
+    }
+
+    /**
+     * @brief Limit the memory used by cached bitmaps.
+     */
+    void set_budget(std::size_t bytes) {
+        _budget = bytes;
+        evict(_budget);
+    }
+
+    std::size_t get_budget() const { return _budget; }
+
+    stats get_stats() const {
+        return {_hits, _misses, _bytes, _lru.size()};
+    }
+
+    void clear() { evict(0); }
+
+    /**
+     * @brief Drop the glyphs of `font`, e.g. before it is unloaded.
+     */
+    void clear(const lv_font_t *font) {
+        for (auto it = _lru.begin(); it != _lru.end();) {
+            if (it->k.font == font) {
+                _bytes -= it->size;
+                _index.erase(it->k);
+                it = _lru.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * @brief The cached bitmap of `letter`, or nullptr.
+     */
+    const uint8_t *find(const lv_font_t *font, uint32_t letter) {
+        auto it = _index.find({font, letter});
+        if (it == _index.end()) {
+            _misses++;
+            return nullptr;
+        }
+
+        _hits++;
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return it->second->bitmap.get();
+    }
+
+    /**
+     * @brief Keep a copy of a decoded bitmap of `size` bytes.
+     *
+     * Returns the copy, or `bitmap` itself if it exceeds the budget.
+     */
+    const uint8_t *insert(const lv_font_t *font, uint32_t letter,
+                          const uint8_t *bitmap, std::size_t size) {
+        if (!bitmap || size > _budget)
+            return bitmap;
+
+        evict(_budget - size);
+        auto copy = std::make_unique<uint8_t[]>(size);
+        memcpy(copy.get(), bitmap, size);
+        _lru.push_front({{font, letter}, size, std::move(copy)});
+        _index.emplace(key{font, letter}, _lru.begin());
+        _bytes += size;
+        return _lru.front().bitmap.get();
+    }
+};
+
+/**
+ * @brief A font drawing its glyphs through the glyph_cache.
+ *
+ * LVGL keeps pointers to fonts, so a cached_font has to outlive every style
+ * and theme it is used in. Uncompressed lv_font_fmt_txt fonts already hand
+ * out their bitmaps without decoding; for them get() returns the wrapped
+ * font itself.
+ */
+class cached_font {
+    const lv_font_t *_base;
+    lv_font_t _font;
+
+    static const lv_font_t *base_of(const lv_font_t *font) {
+        return static_cast<const cached_font *>(font->user_data)->_base;
+    }
+
+    static bool get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc,
+                              uint32_t letter, uint32_t letter_next) {
+        auto base = base_of(font);
+        return base->get_glyph_dsc(base, dsc, letter, letter_next);
+    }
+
+    static const uint8_t *get_glyph_bitmap(const lv_font_t *font,
+                                           uint32_t letter) {
+        auto base = base_of(font);
+        auto &cache = glyph_cache::get();
+        if (auto bitmap = cache.find(base, letter))
+            return bitmap;
+
+        lv_font_glyph_dsc_t dsc{};
+        if (!base->get_glyph_dsc(base, &dsc, letter, 0))
+            return nullptr;
+
+        // decoded glyphs are packed rows of 1, 2, 4 or 8 bits per pixel,
+        // 3 bpp fonts decompress to 4 bpp
+        const std::size_t bits = dsc.bpp == 3 ? 4 : dsc.bpp;
+        const std::size_t size =
+            (std::size_t{dsc.box_w} * dsc.box_h * bits + 7) / 8;
+
+        auto bitmap = base->get_glyph_bitmap(base, letter);
+        return size ? cache.insert(base, letter, bitmap, size) : bitmap;
+    }
+
+    static bool is_plain(const lv_font_t &font) {
+        return font.get_glyph_bitmap == lv_font_get_bitmap_fmt_txt &&
+               static_cast<const lv_font_fmt_txt_dsc_t *>(font.dsc)
+                       ->bitmap_format == LV_FONT_FMT_TXT_PLAIN;
+    }
+
+  public:
+    /**
+     * @param base  font to cache, must outlive the cached_font
+     */
+    explicit cached_font(const lv_font_t &base) : _base{&base}, _font{base} {
+        // constructed first, the cache outlives static cached_fonts
+        glyph_cache::get();
+        _font.get_glyph_dsc = get_glyph_dsc;
+        _font.get_glyph_bitmap = get_glyph_bitmap;
+        _font.user_data = this;
+    }
+
+    cached_font(const cached_font &) = delete;
+    cached_font &operator=(const cached_font &) = delete;
+
+    ~cached_font() { glyph_cache::get().clear(_base); }
+
+    /**
+     * @brief The font to hand to styles and themes.
+     */
+    const lv_font_t *get() const {
+        // subpixel glyphs are laid out differently, leave them alone
+        if (is_plain(*_base) || _base->subpx != LV_FONT_SUBPX_NONE)
+            return _base;
+        return &_font;
+    }
+
+    operator const lv_font_t *() const { return get(); }
+};
+
+/**
+ * @brief Font loaded from an lv_font_conv binary file (`--format bin`).
+ *
+ * The file is memory-mapped and nothing is decoded up front: glyph
+ * descriptors are read from the file when LVGL asks for them, bitmaps are
+ * handed out straight from the mapping. Only the pages of glyphs actually
+ * drawn are read, and processes using the same font file share them through
+ * the page cache.
+ *
+ * Only uncompressed fonts are supported (`--no-compress`); kerning tables
+ * are ignored. When the glyph header isn't a whole number of bytes, the
+ * bitmaps in the file aren't byte aligned and are realigned through the
+ * glyph_cache on first use.
+ */
+class binary_font {
+    mapped_file _file;
+    lv_font_t _font{};
+    const lv_font_t *_fallback = nullptr;
+
+    const uint8_t *_cmap = nullptr;
+    uint32_t _cmap_count = 0;
+    const uint8_t *_loca = nullptr;
+    uint32_t _loca_count = 0;
+    bool _loca32 = false;
+    const uint8_t *_glyf = nullptr;
+    uint32_t _glyf_size = 0;
+
+    uint16_t _default_adv = 0;
+    uint8_t _bpp = 0;
+    uint8_t _xy_bits = 0;
+    uint8_t _wh_bits = 0;
+    uint8_t _adv_bits = 0;
+    /// advance widths are stored in whole pixels instead of 1/16 px
+    bool _adv_int = false;
+
+    /// realigned bitmap that didn't fit into the glyph_cache
+    mutable std::unique_ptr<uint8_t[]> _uncached;
+
+    template <typename T> static T read(const uint8_t *p) {
+        T v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /// MSB first, like lv_font_conv writes them
+    class bit_reader {
+        const uint8_t *_p;
+        uint32_t _bit = 0;
+
+      public:
+        explicit bit_reader(const uint8_t *p) : _p{p} {}
+
+        uint32_t get(uint8_t n) {
+            uint32_t v = 0;
+            for (; n; n--, _bit++)
+                v = v << 1 | ((_p[_bit / 8] >> (7 - _bit % 8)) & 1);
+            return v;
+        }
+
+        int32_t get_signed(uint8_t n) {
+            const auto v = get(n);
+            return n && (v >> (n - 1)) ? int32_t(v) - (int32_t(1) << n)
+                                       : int32_t(v);
+        }
+    };
+
+    struct glyph {
+        uint32_t adv_w; ///< 1/16 px
+        int16_t ofs_x, ofs_y;
+        uint16_t box_w, box_h;
+        const uint8_t *bitmap;
+        uint32_t bitmap_size;
+        /// bit offset of the bitmap, 0 if byte aligned
+        uint8_t shift;
+    };
+
+    static const binary_font &self(const lv_font_t *font) {
+        return *static_cast<const binary_font *>(font->user_data);
+    }
+
+    uint32_t glyph_id(uint32_t letter) const {
+        // subtables are sorted by range_start
+        const uint8_t *sub = nullptr;
+        for (uint32_t i = 0; i < _cmap_count; i++) {
+            auto h = _cmap + 12 + i * 16;
+            if (read<uint32_t>(h + 4) > letter)
+                break;
+            sub = h;
+        }
+        if (!sub)
+            return 0;
+
+        const auto rcp = letter - read<uint32_t>(sub + 4);
+        if (rcp >= read<uint16_t>(sub + 8))
+            return 0;
+
+        const auto start = read<uint16_t>(sub + 10);
+        const auto entries = read<uint16_t>(sub + 12);
+        const auto data = _cmap + read<uint32_t>(sub);
+
+        switch (sub[14]) {
+        case 0: // format0 full
+            return rcp < entries ? start + data[rcp] : 0;
+        case 2: // format0 tiny
+            return start + rcp;
+        case 1:   // sparse full
+        case 3: { // sparse tiny
+            // sorted code point offsets, followed by glyph id offsets
+            uint32_t lo = 0, hi = entries;
+            while (lo < hi) {
+                const auto mid = (lo + hi) / 2;
+                const auto v = read<uint16_t>(data + mid * 2);
+                if (v == rcp)
+                    return sub[14] == 3
+                               ? start + mid
+                               : start + read<uint16_t>(data + entries * 2 +
+                                                        mid * 2);
+                if (v < rcp)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    bool find_glyph(uint32_t letter, glyph &g) const {
+        const auto id = glyph_id(letter);
+        if (id == 0 || id >= _loca_count)
+            return false;
+
+        auto offset = [this](uint32_t i) -> uint32_t {
+            if (i >= _loca_count)
+                return _glyf_size;
+            return _loca32 ? read<uint32_t>(_loca + i * 4)
+                           : read<uint16_t>(_loca + i * 2);
+        };
+        const uint32_t header_bits = _adv_bits + 2u * _xy_bits + 2u * _wh_bits;
+        const auto begin = offset(id);
+        const auto end = offset(id + 1);
+        if (begin >= end || end > _glyf_size ||
+            end - begin < (header_bits + 7) / 8)
+            return false;
+
+        bit_reader bits{_glyf + begin};
+        const uint32_t adv = _adv_bits ? bits.get(_adv_bits) : _default_adv;
+        g.adv_w = _adv_int ? adv * 16 : adv;
+        g.ofs_x = static_cast<int16_t>(bits.get_signed(_xy_bits));
+        g.ofs_y = static_cast<int16_t>(bits.get_signed(_xy_bits));
+        g.box_w = static_cast<uint16_t>(bits.get(_wh_bits));
+        g.box_h = static_cast<uint16_t>(bits.get(_wh_bits));
+
+        g.bitmap = _glyf + begin + header_bits / 8;
+        g.bitmap_size = end - begin - header_bits / 8;
+        g.shift = header_bits % 8;
+        return true;
+    }
+
+    static bool get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc,
+                              uint32_t letter, uint32_t letter_next) {
+        // like lv_font_fmt_txt, a tab is two spaces wide
+        const bool tab = letter == '\t';
+        glyph g;
+        if (!self(font).find_glyph(tab ? ' ' : letter, g)) {
+            auto fb = self(font)._fallback;
+            return fb && fb->get_glyph_dsc(fb, dsc, letter, letter_next);
+        }
+
+        const auto adv = tab ? g.adv_w * 2 : g.adv_w;
+        dsc->adv_w = static_cast<uint16_t>((adv + 8) >> 4);
+        dsc->box_w = tab ? g.box_w * 2 : g.box_w;
+        dsc->box_h = g.box_h;
+        dsc->ofs_x = g.ofs_x;
+        dsc->ofs_y = g.ofs_y;
+        dsc->bpp = self(font)._bpp;
+        return true;
+    }
+
+    static const uint8_t *get_glyph_bitmap(const lv_font_t *font,
+                                           uint32_t letter) {
+        glyph g;
+        if (!self(font).find_glyph(letter, g)) {
+            auto fb = self(font)._fallback;
+            return fb ? fb->get_glyph_bitmap(fb, letter) : nullptr;
+        }
+        if (g.box_w == 0)
+            return nullptr;
+        if (g.shift == 0)
+            return g.bitmap;
+
+        auto &cache = glyph_cache::get();
+        if (auto bitmap = cache.find(font, letter))
+            return bitmap;
+
+        // the bitmap starts mid-byte, shift it into place
+        auto aligned = std::make_unique<uint8_t[]>(g.bitmap_size);
+        for (uint32_t i = 0; i < g.bitmap_size; i++) {
+            const uint8_t next = i + 1 < g.bitmap_size ? g.bitmap[i + 1] : 0;
+            aligned[i] = static_cast<uint8_t>(g.bitmap[i] << g.shift |
+                                              next >> (8 - g.shift));
+        }
+        auto bitmap = cache.insert(font, letter, aligned.get(), g.bitmap_size);
+        // over budget: keep it until the next call
+        if (bitmap == aligned.get())
+            self(font)._uncached = std::move(aligned);
+        return bitmap;
+    }
+
+    bool parse() {
+        const auto data = _file.data();
+        const auto size = _file.size();
+
+        const uint8_t *head = nullptr;
+        uint32_t loca_len = 0;
+        for (std::size_t pos = 0; pos + 8 <= size;) {
+            const auto len = read<uint32_t>(data + pos);
+            if (len < 8 || len > size - pos)
+                return false;
+
+            auto table = data + pos;
+            if (!memcmp(table + 4, "head", 4) && len >= 8 + 40)
+                head = table + 8;
+            else if (!memcmp(table + 4, "cmap", 4) && len >= 12) {
+                _cmap = table;
+                _cmap_count = read<uint32_t>(table + 8);
+                if (12 + uint64_t{_cmap_count} * 16 > len)
+                    return false;
+            } else if (!memcmp(table + 4, "loca", 4) && len >= 12) {
+                _loca = table + 12;
+                _loca_count = read<uint32_t>(table + 8);
+                loca_len = len;
+            } else if (!memcmp(table + 4, "glyf", 4)) {
+                _glyf = table;
+                _glyf_size = len;
+            }
+            pos += len;
+        }
+        if (!head || !_cmap || !_loca || !_glyf)
+            return false;
+
+        _loca32 = head[26] != 0;
+        if (12 + uint64_t{_loca_count} * (_loca32 ? 4 : 2) > loca_len)
+            return false;
+
+        const auto min_y = read<int16_t>(head + 18);
+        const auto max_y = read<int16_t>(head + 20);
+        _default_adv = read<uint16_t>(head + 22);
+        _adv_int = head[28] == 0;
+        _bpp = head[29];
+        _xy_bits = head[30];
+        _wh_bits = head[31];
+        _adv_bits = head[32];
+        if (head[33] != 0) {
+            LV_LOG_ERROR("compressed binary fonts are not supported");
+            return false;
+        }
+
+        _font.get_glyph_dsc = get_glyph_dsc;
+        _font.get_glyph_bitmap = get_glyph_bitmap;
+        _font.line_height = static_cast<lv_coord_t>(max_y - min_y);
+        _font.base_line = static_cast<lv_coord_t>(-min_y);
+        _font.subpx = head[34];
+        _font.underline_position =
+            static_cast<int8_t>(read<int16_t>(head + 36));
+        _font.underline_thickness =
+            static_cast<int8_t>(read<uint16_t>(head + 38));
+        _font.user_data = this;
+        return true;
+    }
+
+  public:
+    explicit binary_font(const char *path) {
+        // constructed first, the cache outlives static binary_fonts
+        glyph_cache::get();
+        if (!_file.open(path)) {
+            LV_LOG_ERROR("cannot map font %s", path);
+            return;
+        }
+        // glyphs are looked up all over the file, don't read ahead
+        _file.advise(MADV_RANDOM);
+        if (!parse()) {
+            LV_LOG_ERROR("invalid binary font %s", path);
+            _file.close();
+        }
+    }
+
+    binary_font(const binary_font &) = delete;
+    binary_font &operator=(const binary_font &) = delete;
+
+    ~binary_font() { glyph_cache::get().clear(&_font); }
+
+    bool is_open() const { return _file.is_open(); }
+
+    /**
+     * @brief The font to hand to styles and themes, nullptr if loading
+     * failed. It must not be used after the binary_font is destroyed.
+     */
+    const lv_font_t *get() const { return is_open() ? &_font : nullptr; }
+
+    operator const lv_font_t *() const { return get(); }
+
+    /**
+     * @brief Use `font` for glyphs missing in this one.
+     *
+     * LVGL 8.0 has no font fallback of its own, so the lookups are handed
+     * on here. `font` must outlive the binary_font.
+     */
+    void set_fallback(const lv_font_t *font) { _fallback = font; }
+};
+
+} // namespace lvgl
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_mem.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace lvgl {
+
+/**
+ * @brief Heap usage of one object and its subtree.
+ *
+ * Sizes are the capacities of the blocks (see lvgl_mem.hpp), so arrays with
+ * room reserved by mem::reserve(), e.g. through make_many(), show up with
+ * the memory they actually hold. Shared styles (e.g. `lvgl::style`
+ * instances) are not owned by an object and are not counted.
+ */
+struct footprint_node {
+    const lv_obj_t *obj;
+    std::string class_name;
+
+    std::size_t object = 0;    ///< the object struct itself
+    std::size_t spec_attr = 0; ///< special attributes incl. children array
+    std::size_t events = 0;    ///< event descriptor array
+    std::size_t styles = 0;    ///< style list plus local styles
+    std::size_t text = 0;      ///< text owned by the widget
+
+    /// own usage plus the usage of all descendants
+    std::size_t cumulative = 0;
+    std::vector<footprint_node> children;
+
+    std::size_t self() const {
+        return object + spec_attr + events + styles + text;
+    }
+
+    /**
+     * @brief Print the subtree, skipping nodes below `min_bytes` cumulative.
+     */
+    void print(FILE *out = stdout, std::size_t min_bytes = 0,
+               int depth = 0) const {
+        if (cumulative < min_bytes)
+            return;
+
+        fprintf(out,
+                "%*s%-*s %8zu B total %6zu B self (obj %zu, spec %zu, "
+                "events %zu, styles %zu, text %zu)\n",
+                depth * 2, "", 24 - depth * 2 > 0 ? 24 - depth * 2 : 0,
+                class_name.c_str(), cumulative, self(), object, spec_attr,
+                events, styles, text);
+
+        for (auto &c : children)
+            c.print(out, min_bytes, depth + 1);
+    }
+};
+
+struct compaction_result {
+    std::size_t objects = 0;  ///< objects visited
+    std::size_t released = 0; ///< bytes returned to the allocator
+};
+
+/**
+ * @brief Measures and trims the heap usage of widget trees.
+ */
+class footprint {
+    // arrays with zero entries may point to LVGL's zero-size sentinel,
+    // which is not a real block; lv_mem_alloc(0) returns its address
+    static bool is_zero_sentinel(const void *ptr) {
+        static const void *const sentinel = lv_mem_alloc(0);
+        return ptr == sentinel;
+    }
+
+    static std::size_t array_size(const void *ptr) {
+        return ptr && !is_zero_sentinel(ptr) ? mem::block_capacity(ptr) : 0;
+    }
+
+    static std::size_t text_size(const char *txt, bool is_static) {
+        return txt && !is_static ? mem::block_capacity(txt) : 0;
+    }
+
+    static std::size_t local_style_size(const lv_style_t *style) {
+        std::size_t size = mem::block_capacity(style);
+        if (!style->is_const && style->prop_cnt > 1)
+            size += mem::block_capacity(style->v_p.values_and_props);
+        return size;
+    }
+
+    static footprint_node measure(const lv_obj_t *obj) {
+        footprint_node n;
+        n.obj = obj;
+        n.class_name = mem::class_name(lv_obj_get_class(obj));
+        n.object = mem::block_capacity(obj);
+
+        for (uint32_t i = 0; i < obj->style_cnt; i++) {
+            auto &s = obj->styles[i];
+            if (s.is_local || s.is_trans)
+                n.styles += local_style_size(s.style);
+        }
+        n.styles += array_size(obj->styles);
+
+        if (auto spec = obj->spec_attr) {
+            n.spec_attr =
+                mem::block_capacity(spec) + array_size(spec->children);
+            n.events = array_size(spec->event_dsc);
+        }
+
+#if LV_USE_LABEL
+        if (lv_obj_check_type(obj, &lv_label_class)) {
+            auto label = reinterpret_cast<const lv_label_t *>(obj);
+            n.text = text_size(label->text, label->static_txt);
+        }
+#endif
+#if LV_USE_CHECKBOX
+        if (lv_obj_check_type(obj, &lv_checkbox_class)) {
+            auto cb = reinterpret_cast<const lv_checkbox_t *>(obj);
+            n.text = text_size(cb->txt, cb->static_txt);
+        }
+#endif
+#if LV_USE_TEXTAREA
+        if (lv_obj_check_type(obj, &lv_textarea_class)) {
+            auto ta = reinterpret_cast<const lv_textarea_t *>(obj);
+            n.text = text_size(ta->placeholder_txt, false);
+        }
+#endif
+
+        n.cumulative = n.self();
+        for (uint32_t i = 0, cnt = lv_obj_get_child_cnt(obj); i < cnt; i++) {
+            auto &c = n.children.emplace_back(
+                measure(lv_obj_get_child(obj, static_cast<int32_t>(i))));
+            n.cumulative += c.cumulative;
+        }
+
+        return n;
+    }
+
+    /// shrink `ptr` to `cnt` elements, releasing it entirely for 0
+    template <typename T>
+    static std::size_t trim(T *&ptr, std::size_t cnt) {
+        if (!ptr)
+            return 0;
+
+        if (cnt == 0) {
+            // lv_mem_free() ignores the sentinel
+            const auto size = array_size(ptr);
+            lv_mem_free(ptr);
+            ptr = nullptr;
+            return size;
+        }
+
+        const auto have = mem::block_capacity(ptr);
+        const auto need = cnt * sizeof(T);
+        if (have <= need)
+            return 0;
+
+        if (auto p = lv_mem_realloc(ptr, need))
+            ptr = static_cast<T *>(p);
+        return have - need;
+    }
+
+    static std::size_t remove_empty_local_styles(lv_obj_t *obj) {
+        std::size_t released = 0;
+        uint32_t kept = 0;
+
+        for (uint32_t i = 0; i < obj->style_cnt; i++) {
+            auto s = obj->styles[i];
+            if (s.is_local && !s.style->is_const && s.style->prop_cnt == 0) {
+                released += local_style_size(s.style);
+                lv_style_reset(s.style);
+                lv_mem_free(s.style);
+            } else {
+                obj->styles[kept++] = s;
+            }
+        }
+
+        obj->style_cnt = kept;
+        return released;
+    }
+
+    /// the special attributes are optional and can go when all are default
+    static bool spec_attr_is_default(const _lv_obj_spec_attr_t *spec) {
+        return spec->child_cnt == 0 && spec->group_p == nullptr &&
+               spec->event_dsc_cnt == 0 && spec->scroll.x == 0 &&
+               spec->scroll.y == 0 && spec->ext_click_pad == 0 &&
+               spec->ext_draw_size == 0 &&
+               spec->scrollbar_mode == LV_SCROLLBAR_MODE_AUTO &&
+               spec->scroll_snap_x == LV_SCROLL_SNAP_NONE &&
+               spec->scroll_snap_y == LV_SCROLL_SNAP_NONE &&
+               spec->scroll_dir == LV_DIR_ALL;
+    }
+
+    static void compact(lv_obj_t *obj, compaction_result &res) {
+        res.objects++;
+
+        res.released += remove_empty_local_styles(obj);
+        res.released += trim(obj->styles, obj->style_cnt);
+
+        if (auto spec = obj->spec_attr) {
+            res.released += trim(spec->children, spec->child_cnt);
+            res.released += trim(spec->event_dsc, spec->event_dsc_cnt);
+
+            if (spec_attr_is_default(spec)) {
+                res.released += mem::block_capacity(spec);
+                lv_mem_free(spec);
+                obj->spec_attr = nullptr;
+            }
+        }
+
+        for (uint32_t i = 0, cnt = lv_obj_get_child_cnt(obj); i < cnt; i++)
+            compact(lv_obj_get_child(obj, static_cast<int32_t>(i)), res);
+    }
+
+  public:
+    /**
+     * @brief Report the heap usage of `root` and all its descendants.
+     */
+    static footprint_node measure(object_ref root) {
+        return measure(root.get_object());
+    }
+
+    /**
+     * @brief Release unused memory in the tree below `root`.
+     *
+     * Trims style, children and event arrays to their used size, which
+     * also gives back room reserved with mem::reserve(). Drops local styles
+     * that no longer hold any property and frees special attributes that
+     * only hold default values. Rendering is not affected.
+     */
+    static compaction_result compact(object_ref root) {
+        compaction_result res;
+        compact(root.get_object(), res);
+        return res;
+    }
+};
+
+} // namespace lvgl
@@ -0,0 +1,500 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_executor.hpp"
+#include "lvgl_image_format.hpp"
+#include "lvgl_mmap.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Images converted at build time (tools/png2img, lvgl_add_images() in
+ * CMakeLists.txt) and loaded without decoding.
+ *
+ * An `image_file` maps the converted file and describes the mapped pixels
+ * with an lv_img_dsc_t, so LVGL draws straight from the page cache. Only
+ * run-length encoded images are decoded, once, into memory of their own.
+ *
+ * An `async_image` widget does that decoding on a worker thread instead, for
+ * large images or many of them, like in a gallery.
+ */
+namespace lvgl {
+
+namespace detail {
+
+/// a validated image file
+struct image_view {
+    image_format::header h;
+    /// pixel data as stored in the file
+    const uint8_t *stored;
+};
+
+/// @return nullptr if the file is usable, otherwise why not
+inline const char *parse_image(const mapped_file &file, image_view &v) {
+    namespace fmt = image_format;
+
+    auto &h = v.h;
+    if (file.size() < sizeof(h))
+        return "truncated";
+    memcpy(&h, file.data(), sizeof(h));
+
+    if (memcmp(h.magic, fmt::magic, sizeof(h.magic)) ||
+        h.version != fmt::version)
+        return "not a converted image";
+
+    const bool swap16 = h.flags & fmt::swap16;
+    if (h.color_depth != LV_COLOR_DEPTH ||
+        (LV_COLOR_DEPTH == 16 && swap16 != bool(LV_COLOR_16_SWAP)))
+        return "converted for another color format";
+
+    const auto px_size =
+        fmt::pixel_size(h.color_depth, h.flags & fmt::has_alpha);
+    if (h.width > 2047 || h.height > 2047 ||
+        h.data_size != std::size_t(h.width) * h.height * px_size ||
+        h.data_offset % fmt::data_alignment || h.data_offset > file.size() ||
+        h.stored_size > file.size() - h.data_offset ||
+        (!(h.flags & fmt::rle) && h.stored_size != h.data_size))
+        return "corrupt header";
+
+    v.stored = file.data() + h.data_offset;
+    return nullptr;
+}
+
+/// write the decoded pixels (`v.h.data_size` bytes) to `out`
+inline bool unpack_image(const image_view &v, uint8_t *out) {
+    namespace fmt = image_format;
+
+    if (!(v.h.flags & fmt::rle)) {
+        memcpy(out, v.stored, v.h.data_size);
+        return true;
+    }
+    return fmt::rle_decode(
+        v.stored, v.h.stored_size, out, v.h.data_size,
+        fmt::pixel_size(v.h.color_depth, v.h.flags & fmt::has_alpha));
+}
+
+inline lv_img_dsc_t make_dsc(const image_format::header &h,
+                             const uint8_t *data) {
+    lv_img_dsc_t dsc{};
+    dsc.header.cf = h.flags & image_format::has_alpha
+                        ? LV_IMG_CF_TRUE_COLOR_ALPHA
+                        : LV_IMG_CF_TRUE_COLOR;
+    dsc.header.w = h.width;
+    dsc.header.h = h.height;
+    dsc.data_size = h.data_size;
+    dsc.data = data;
+    return dsc;
+}
+
+} // namespace detail
+
+class image_file {
+    mapped_file _file;
+    std::unique_ptr<uint8_t[]> _decoded;
+    lv_img_dsc_t _dsc{};
+
+    const char *load() {
+        detail::image_view v;
+        if (auto err = detail::parse_image(_file, v))
+            return err;
+
+        auto data = v.stored;
+        if (v.h.flags & image_format::rle) {
+            _decoded = std::make_unique<uint8_t[]>(v.h.data_size);
+            if (!detail::unpack_image(v, _decoded.get()))
+                return "corrupt pixel data";
+            data = _decoded.get();
+            _file.close();
+        }
+        _dsc = detail::make_dsc(v.h, data);
+        return nullptr;
+    }
+
+  public:
+    explicit image_file(const char *path) {
+        if (!_file.open(path)) {
+            LV_LOG_ERROR("cannot map image %s", path);
+            return;
+        }
+        const auto err = load();
+        if (err) {
+            LV_LOG_ERROR("%s: %s", path, err);
+            _file.close();
+            _decoded.reset();
+            _dsc = {};
+        }
+    }
+
+    // LVGL keeps pointing at the descriptor
+    image_file(const image_file &) = delete;
+    image_file &operator=(const image_file &) = delete;
+
+    ~image_file() {
+        if (is_open())
+            lv_img_cache_invalidate_src(&_dsc);
+    }
+
+    bool is_open() const { return _dsc.data != nullptr; }
+
+    /**
+     * @brief The image source for LVGL, nullptr if loading failed.
+     */
+    const lv_img_dsc_t *get() const { return is_open() ? &_dsc : nullptr; }
+
+    lv_coord_t get_width() const { return _dsc.header.w; }
+    lv_coord_t get_height() const { return _dsc.header.h; }
+};
+
+class image : public object {
+  public:
+    image(object_ref parent) : object{lv_img_create, parent} {}
+
+    /**
+     * @brief Show `src`, which must outlive its use by the widget.
+     */
+    void set_src(const image_file &src) { set_src(src.get()); }
+
+    void set_src(const lv_img_dsc_t *src) {
+        mem::scope s{get_object()};
+        lv_img_set_src(get_object(), src);
+    }
+
+    /// 256 is 100%
+    void set_zoom(uint16_t zoom) { lv_img_set_zoom(get_object(), zoom); }
+
+    /// in 0.1 degrees
+    void set_angle(int16_t angle) { lv_img_set_angle(get_object(), angle); }
+};
+
+/**
+ * @brief Pixels borrowed from the image_buffer_pool, returned on
+ * destruction.
+ */
+class image_buffer {
+    friend class image_buffer_pool;
+
+    uint8_t *_data = nullptr;
+    std::size_t _capacity = 0;
+
+    image_buffer(uint8_t *data, std::size_t capacity)
+        : _data{data}, _capacity{capacity} {}
+
+  public:
+    image_buffer() = default;
+
+    image_buffer(image_buffer &&other) noexcept
+        : _data{std::exchange(other._data, nullptr)},
+          _capacity{std::exchange(other._capacity, 0)} {}
+
+    image_buffer &operator=(image_buffer &&other) noexcept {
+        if (this != &other) {
+            reset();
+            _data = std::exchange(other._data, nullptr);
+            _capacity = std::exchange(other._capacity, 0);
+        }
+        return *this;
+    }
+
+    ~image_buffer() { reset(); }
+
+    inline void reset();
+
+    uint8_t *data() const { return _data; }
+
+    std::size_t capacity() const { return _capacity; }
+};
+
+/**
+ * @brief Recycles the buffers of decoded images.
+ *
+ * Images in a gallery tend to have the same size, so the buffer of an image
+ * scrolled out of view usually fits the next one, and the heap doesn't
+ * fragment. Buffers can be taken and returned on any thread. Idle buffers
+ * are kept up to the budget, the oldest are freed first.
+ */
+class image_buffer_pool {
+    friend class image_buffer;
+
+    struct block {
+        std::size_t capacity;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    mutable std::mutex _mtx;
+    std::deque<block> _idle; // oldest first
+    std::size_t _idle_bytes = 0;
+    std::size_t _budget = 4 * 1024 * 1024;
+    uint64_t _reused = 0;
+    uint64_t _allocated = 0;
+
+    void evict() {
+        while (_idle_bytes > _budget && !_idle.empty()) {
+            _idle_bytes -= _idle.front().capacity;
+            _idle.pop_front();
+        }
+    }
+
+    void put(uint8_t *data, std::size_t capacity) {
+        std::lock_guard lock{_mtx};
+        _idle.push_back({capacity, std::unique_ptr<uint8_t[]>{data}});
+        _idle_bytes += capacity;
+        evict();
+    }
+
+  public:
+    struct stats {
+        uint64_t reused;
+        uint64_t allocated;
+        std::size_t idle_bytes;
+        std::size_t idle_buffers;
+    };
+
+    static image_buffer_pool &get() {
+        static image_buffer_pool pool;
+        return pool;
+    }
+
+    /**
+     * @brief A buffer of at least `size` bytes.
+     */
+    image_buffer acquire(std::size_t size) {
+        {
+            std::lock_guard lock{_mtx};
+            // the smallest idle buffer that fits, if it's less than twice
+            // the size
+            auto best = _idle.end();
+            for (auto it = _idle.begin(); it != _idle.end(); ++it) {
+                if (it->capacity >= size && it->capacity / 2 <= size &&
+                    (best == _idle.end() || it->capacity < best->capacity))
+                    best = it;
+            }
+            if (best != _idle.end()) {
+                image_buffer buf{best->data.release(), best->capacity};
+                _idle_bytes -= best->capacity;
+                _idle.erase(best);
+                _reused++;
+                return buf;
+            }
+            _allocated++;
+        }
+
+        // whole pages, so images of about the same size share buffers
+        const auto capacity = (size + 4095) & ~std::size_t{4095};
+        return {new uint8_t[capacity], capacity};
+    }
+
+    /**
+     * @brief Limit the memory kept in idle buffers.
+     */
+    void set_budget(std::size_t bytes) {
+        std::lock_guard lock{_mtx};
+        _budget = bytes;
+        evict();
+    }
+
+    std::size_t get_budget() const {
+        std::lock_guard lock{_mtx};
+        return _budget;
+    }
+
+    stats get_stats() const {
+        std::lock_guard lock{_mtx};
+        return {_reused, _allocated, _idle_bytes, _idle.size()};
+    }
+};
+
+inline void image_buffer::reset() {
+    if (_data)
+        image_buffer_pool::get().put(std::exchange(_data, nullptr),
+                                     std::exchange(_capacity, 0));
+}
+
+namespace detail {
+
+/// map and unpack `path` into a pooled buffer; runs on a worker
+inline const char *decode_image(const char *path, image_buffer &pixels,
+                                image_format::header &h) {
+    mapped_file file{path};
+    if (!file.is_open())
+        return "cannot map";
+    file.advise(MADV_SEQUENTIAL);
+
+    image_view v;
+    if (auto err = parse_image(file, v))
+        return err;
+    pixels = image_buffer_pool::get().acquire(v.h.data_size);
+    if (!unpack_image(v, pixels.data()))
+        return "corrupt pixel data";
+    h = v.h;
+    return nullptr;
+}
+
+} // namespace detail
+
+/**
+ * @brief Image widget that decodes its file on a worker thread.
+ *
+ * load() returns right away; the file is mapped and unpacked on
+ * thread_pool::background() into a buffer of the image_buffer_pool. Until
+ * then the widget draws a placeholder, the preview given to set_preview()
+ * scaled to fit, or a plain rectangle. The decoded image is published on the
+ * LVGL thread in one step followed by a single invalidation, so no frame
+ * shows a partly decoded image.
+ *
+ * The widget keeps the size it is given, like a gallery cell; the image is
+ * centred and clipped. The run loop has to call ui_queue::drain().
+ */
+class async_image : public object {
+    // shared with pending decodes, which can outlive the widget
+    struct state {
+        /// bumped by load() and on deletion; stale decodes are dropped
+        std::atomic<uint32_t> generation{0};
+        // LVGL thread only
+        lv_obj_t *obj = nullptr;
+        image_buffer pixels;
+        lv_img_dsc_t dsc{};
+        const lv_img_dsc_t *preview = nullptr;
+        lv_color_t placeholder = lv_palette_main(LV_PALETTE_GREY);
+    };
+
+    std::shared_ptr<state> _state = std::make_shared<state>();
+
+    static void draw(lv_event_t *ev) {
+        auto s = static_cast<state *>(lv_event_get_user_data(ev));
+        auto clip = lv_event_get_clip_area(ev);
+
+        lv_area_t coords;
+        lv_obj_get_coords(s->obj, &coords);
+        const bool loaded = s->dsc.data != nullptr;
+
+        if (!loaded) {
+            lv_draw_rect_dsc_t rect;
+            lv_draw_rect_dsc_init(&rect);
+            rect.bg_color = s->placeholder;
+            rect.bg_opa = LV_OPA_COVER;
+            lv_draw_rect(&coords, clip, &rect);
+        }
+
+        auto src = loaded ? &s->dsc : s->preview;
+        if (!src || !src->header.w || !src->header.h)
+            return;
+
+        const lv_coord_t w = src->header.w;
+        const lv_coord_t h = src->header.h;
+        lv_draw_img_dsc_t img;
+        lv_draw_img_dsc_init(&img);
+        if (!loaded) {
+            const int32_t zoom =
+                std::min(lv_area_get_width(&coords) * LV_IMG_ZOOM_NONE / w,
+                         lv_area_get_height(&coords) * LV_IMG_ZOOM_NONE / h);
+            // a tiny preview in a large cell exceeds the 16 bit zoom
+            img.zoom = static_cast<uint16_t>(
+                std::clamp<int32_t>(zoom, 1, UINT16_MAX));
+            img.pivot = {0, 0};
+        }
+
+        // centred; lv_draw_img() takes the area before zooming
+        const auto zoomed_w = w * img.zoom / LV_IMG_ZOOM_NONE;
+        const auto zoomed_h = h * img.zoom / LV_IMG_ZOOM_NONE;
+        lv_area_t area;
+        area.x1 = coords.x1 + (lv_area_get_width(&coords) - zoomed_w) / 2;
+        area.y1 = coords.y1 + (lv_area_get_height(&coords) - zoomed_h) / 2;
+        area.x2 = area.x1 + w - 1;
+        area.y2 = area.y1 + h - 1;
+        lv_draw_img(&area, clip, src, &img);
+    }
+
+    /// also runs when LVGL deletes the object, e.g. with its parent
+    static void detach(lv_event_t *ev) {
+        auto s = static_cast<state *>(lv_event_get_user_data(ev));
+        s->generation++;
+        s->obj = nullptr;
+        lv_img_cache_invalidate_src(&s->dsc);
+    }
+
+    static task decode(std::shared_ptr<state> s, std::string path,
+                       uint32_t generation) {
+        co_await thread_pool::background().schedule();
+
+        image_buffer pixels;
+        image_format::header h{};
+        const char *err = nullptr;
+        // skipped if the widget was deleted or reloaded in the meantime,
+        // e.g. scrolled past
+        if (s->generation.load(std::memory_order_relaxed) == generation)
+            err = detail::decode_image(path.c_str(), pixels, h);
+
+        co_await resume_on_ui();
+
+        if (s->generation.load(std::memory_order_relaxed) != generation)
+            co_return;
+        if (err) {
+            LV_LOG_ERROR("%s: %s", path.c_str(), err);
+            co_return;
+        }
+
+        // the previous image may still be in LVGL's image cache
+        lv_img_cache_invalidate_src(&s->dsc);
+        s->pixels = std::move(pixels);
+        s->dsc = detail::make_dsc(h, s->pixels.data());
+        if (s->obj)
+            lv_obj_invalidate(s->obj);
+    }
+
+  public:
+    async_image(object_ref parent) : object{lv_obj_create, parent} {
+        auto obj = get_object();
+        _state->obj = obj;
+        lv_obj_remove_style_all(obj);
+        // presses go to the parent, so a gallery can be dragged
+        lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+        mem::scope s{obj};
+        lv_obj_add_event_cb(obj, draw, LV_EVENT_DRAW_MAIN, _state.get());
+        lv_obj_add_event_cb(obj, detach, LV_EVENT_DELETE, _state.get());
+    }
+
+    // pending decodes refer to the LVGL object
+    async_image(async_image &&) = delete;
+    async_image &operator=(async_image &&) = delete;
+
+    ~async_image() {
+        // here, while detach() can still reach the state
+        if (auto obj = release())
+            lv_obj_del(obj);
+    }
+
+    /**
+     * @brief Decode the converted image at `path` in the background.
+     *
+     * A previously loaded image stays visible until the new one is ready.
+     */
+    void load(const char *path) {
+        decode(_state, path, ++_state->generation);
+    }
+
+    bool is_loaded() const { return _state->dsc.data != nullptr; }
+
+    /**
+     * @brief Shown scaled while loading, e.g. a small thumbnail converted
+     * at build time; `preview` must outlive the widget.
+     */
+    void set_preview(const lv_img_dsc_t *preview) {
+        _state->preview = preview;
+        if (!is_loaded())
+            invalidate();
+    }
+
+    void set_preview(const image_file &preview) { set_preview(preview.get()); }
+
+    void set_placeholder_color(lv_color_t color) {
+        _state->placeholder = color;
+        if (!is_loaded())
+            invalidate();
+    }
+};
+
+} // namespace lvgl
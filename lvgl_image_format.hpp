@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * File format of pre-rasterised images, written by tools/png2img and read by
+ * lvgl::image_file (lvgl_image.hpp).
+ *
+ * A 32 byte header is followed by the pixels in LVGL's native true color
+ * format for the configured LV_COLOR_DEPTH (with an alpha byte per pixel
+ * for 8 and 16 bit colors, in the color's alpha channel for 32 bit), so an
+ * uncompressed image can be used directly from a memory mapping. All values
+ * are little endian. This header doesn't depend on LVGL, so the converter
+ * can be built for the host.
+ */
+namespace lvgl::image_format {
+
+inline constexpr char magic[4] = {'L', 'V', 'I', 'M'};
+inline constexpr uint8_t version = 1;
+/// pixel data starts at a multiple of this
+inline constexpr uint32_t data_alignment = 16;
+
+enum flags : uint8_t {
+    /// pixels carry alpha (LV_IMG_CF_TRUE_COLOR_ALPHA)
+    has_alpha = 1,
+    /// pixel data is run-length encoded, see rle_encode()
+    rle = 2,
+    /// 16 bit colors have their bytes swapped (LV_COLOR_16_SWAP)
+    swap16 = 4,
+};
+
+struct header {
+    char magic[4];
+    uint8_t version;
+    uint8_t color_depth;
+    uint8_t flags;
+    uint8_t reserved0;
+    uint16_t width;
+    uint16_t height;
+    /// size of the decoded pixel data
+    uint32_t data_size;
+    /// size of the pixel data in the file
+    uint32_t stored_size;
+    uint32_t data_offset;
+    uint32_t reserved1[2];
+};
+static_assert(sizeof(header) == 32);
+
+/// bytes per pixel for `color_depth` 8, 16 or 32
+inline constexpr std::size_t pixel_size(uint8_t color_depth, bool alpha) {
+    return color_depth == 32 ? 4 : color_depth / 8 + (alpha ? 1 : 0);
+}
+
+/**
+ * @brief Run-length encode pixels of `px_size` bytes.
+ *
+ * Each packet starts with a control byte: `0x80 | (n - 1)` is followed by
+ * one pixel repeated n times, `n - 1` by n literal pixels (n <= 128).
+ */
+inline std::vector<uint8_t> rle_encode(const uint8_t *px, std::size_t count,
+                                       std::size_t px_size) {
+    std::vector<uint8_t> out;
+    auto same = [&](std::size_t a, std::size_t b) {
+        return !memcmp(px + a * px_size, px + b * px_size, px_size);
+    };
+
+    std::size_t i = 0;
+    while (i < count) {
+        std::size_t run = 1;
+        while (i + run < count && run < 128 && same(i, i + run))
+            run++;
+
+        if (run > 1) {
+            out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+            out.insert(out.end(), px + i * px_size, px + (i + 1) * px_size);
+            i += run;
+            continue;
+        }
+
+        // literals up to the next run
+        std::size_t n = 1;
+        while (i + n < count && n < 128 &&
+               !(i + n + 1 < count && same(i + n, i + n + 1)))
+            n++;
+        out.push_back(static_cast<uint8_t>(n - 1));
+        out.insert(out.end(), px + i * px_size, px + (i + n) * px_size);
+        i += n;
+    }
+    return out;
+}
+
+/**
+ * @brief Decode rle_encode() output into exactly `out_size` bytes.
+ */
+inline bool rle_decode(const uint8_t *in, std::size_t in_size, uint8_t *out,
+                       std::size_t out_size, std::size_t px_size) {
+    const auto in_end = in + in_size;
+    const auto out_end = out + out_size;
+
+    while (in < in_end) {
+        const auto ctrl = *in++;
+        const std::size_t n = (ctrl & 0x7f) + 1u;
+        if (std::size_t(out_end - out) < n * px_size)
+            return false;
+
+        if (ctrl & 0x80) {
+            if (std::size_t(in_end - in) < px_size)
+                return false;
+            for (std::size_t k = 0; k < n; k++, out += px_size)
+                memcpy(out, in, px_size);
+            in += px_size;
+        } else {
+            if (std::size_t(in_end - in) < n * px_size)
+                return false;
+            memcpy(out, in, n * px_size);
+            in += n * px_size;
+            out += n * px_size;
+        }
+    }
+    return out == out_end;
+}
+
+} // namespace lvgl::image_format
@@ -0,0 +1,482 @@
+#include "lvgl_mem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace lvgl::mem {
+
+class account {
+  public:
+    const kind type;
+    const void *key;
+    const uint32_t id;
+    std::string name;
+    bool alive = true;
+
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> blocks{0};
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<int64_t> peak_bytes{0};
+    /// took over the blocks of this account, see merge_into()
+    std::atomic<account *> merged{nullptr};
+
+    account(kind type, const void *key, uint32_t id, std::string name)
+        : type{type}, key{key}, id{id}, name{std::move(name)} {}
+
+    void resize(int64_t delta) {
+        auto now = bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+        auto peak = peak_bytes.load(std::memory_order_relaxed);
+        while (now > peak && !peak_bytes.compare_exchange_weak(
+                                 peak, now, std::memory_order_relaxed)) {
+        }
+    }
+
+    void add_block(std::size_t size) {
+        blocks.fetch_add(1, std::memory_order_relaxed);
+        allocs.fetch_add(1, std::memory_order_relaxed);
+        resize(static_cast<int64_t>(size));
+    }
+
+    void remove_block(std::size_t size) {
+        blocks.fetch_sub(1, std::memory_order_relaxed);
+        frees.fetch_add(1, std::memory_order_relaxed);
+        resize(-static_cast<int64_t>(size));
+    }
+
+    /// the account blocks charged to this one are now kept by
+    account *owner() {
+        auto m = merged.load(std::memory_order_acquire);
+        return m ? m : this;
+    }
+
+    /**
+     * @brief Move everything charged so far to `to`; blocks that are still
+     * charged here follow through owner().
+     */
+    void merge_into(account &to) {
+        to.blocks.fetch_add(blocks.exchange(0), std::memory_order_relaxed);
+        to.allocs.fetch_add(allocs.exchange(0), std::memory_order_relaxed);
+        to.frees.fetch_add(frees.exchange(0), std::memory_order_relaxed);
+        to.resize(bytes.exchange(0));
+        alive = false;
+        merged.store(&to, std::memory_order_release);
+    }
+
+    usage get_usage() const {
+        return {bytes.load(std::memory_order_relaxed),
+                blocks.load(std::memory_order_relaxed),
+                allocs.load(std::memory_order_relaxed),
+                frees.load(std::memory_order_relaxed),
+                peak_bytes.load(std::memory_order_relaxed)};
+    }
+};
+
+namespace {
+
+struct alignas(alignof(std::max_align_t)) block_header {
+    /// bytes requested by LVGL
+    std::size_t size;
+    /// bytes usable without moving the block, see reserve()
+    std::size_t capacity;
+    account *cls;
+    account *scr;
+};
+
+struct class_entry {
+    const lv_obj_class_t *cls;
+    const char *name;
+};
+
+// names follow the wrappers in lvgl.hpp
+const class_entry class_names[] = {
+    {&lv_obj_class, "object"},
+#if LV_USE_BTN
+    {&lv_btn_class, "button"},
+#endif
+#if LV_USE_LABEL
+    {&lv_label_class, "label"},
+#endif
+#if LV_USE_BAR
+    {&lv_bar_class, "bar"},
+#endif
+#if LV_USE_SLIDER
+    {&lv_slider_class, "slider"},
+#endif
+#if LV_USE_SPINBOX
+    {&lv_spinbox_class, "spinbox"},
+#endif
+#if LV_USE_METER
+    {&lv_meter_class, "meter"},
+#endif
+#if LV_USE_LED
+    {&lv_led_class, "led"},
+#endif
+#if LV_USE_MSGBOX
+    {&lv_msgbox_class, "msg_box"},
+#endif
+#if LV_USE_CHECKBOX
+    {&lv_checkbox_class, "checkbox"},
+#endif
+#if LV_USE_SWITCH
+    {&lv_switch_class, "lv_switch"},
+#endif
+#if LV_USE_TEXTAREA
+    {&lv_textarea_class, "text_field"},
+#endif
+#if LV_USE_CALENDAR
+    {&lv_calendar_class, "calendar"},
+#endif
+#if LV_USE_CHART
+    {&lv_chart_class, "chart"},
+#endif
+#if LV_USE_IMG
+    {&lv_img_class, "image"},
+#endif
+};
+
+std::string name_of(const lv_obj_class_t *cls) {
+    for (auto &n : class_names) {
+        if (n.cls == cls)
+            return n.name;
+    }
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "class@%p", static_cast<const void *>(cls));
+    return buf;
+}
+
+std::string name_of_screen(const lv_obj_t *scr) {
+    auto disp = lv_obj_get_disp(scr);
+    if (disp && scr == lv_disp_get_layer_top(disp))
+        return "top_layer";
+    if (disp && scr == lv_disp_get_layer_sys(disp))
+        return "sys_layer";
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "screen@%p", static_cast<const void *>(scr));
+    return buf;
+}
+
+class registry {
+    std::deque<account> _accounts;
+    std::unordered_map<const void *, account *> _by_ctor;
+    std::unordered_map<const void *, account *> _by_class;
+    std::unordered_map<const void *, account *> _by_screen;
+
+  public:
+    std::mutex lock;
+    account &unattributed_class;
+    account &unattributed_screen;
+
+    registry()
+        : unattributed_class{_accounts.emplace_back(
+              kind::widget_class, nullptr, 0, "unattributed")},
+          unattributed_screen{_accounts.emplace_back(kind::screen, nullptr, 1,
+                                                     "unattributed")} {}
+
+    account *create(kind type, const void *key, std::string name) {
+        return &_accounts.emplace_back(
+            type, key, static_cast<uint32_t>(_accounts.size()),
+            std::move(name));
+    }
+
+    account *for_ctor(const void *ctor) {
+        auto &acc = _by_ctor[ctor];
+        if (!acc)
+            acc = create(kind::widget_class, nullptr, {});
+        return acc;
+    }
+
+    account *for_class(const lv_obj_class_t *cls) {
+        auto &acc = _by_class[cls];
+        if (!acc)
+            acc = create(kind::widget_class, cls, name_of(cls));
+        return acc;
+    }
+
+    void bind_class(account *acc, const lv_obj_class_t *cls) {
+        if (acc->name.empty())
+            acc->name = name_of(cls);
+        _by_class.try_emplace(cls, acc);
+    }
+
+    account *for_screen(const lv_obj_t *scr) {
+        auto &acc = _by_screen[scr];
+        if (!acc)
+            acc = create(kind::screen, scr, name_of_screen(scr));
+        return acc;
+    }
+
+    void bind_screen(account *acc, const lv_obj_t *scr) {
+        _by_screen[scr] = acc;
+    }
+
+    void screen_deleted(const lv_obj_t *scr) {
+        auto it = _by_screen.find(scr);
+        if (it != _by_screen.end()) {
+            it->second->alive = false;
+            _by_screen.erase(it);
+        }
+    }
+
+    const auto &accounts() const { return _accounts; }
+};
+
+registry &get_registry() {
+    static registry reg;
+    return reg;
+}
+
+thread_local account *current_class = nullptr;
+thread_local account *current_screen = nullptr;
+
+#ifdef LVGL_MEM_ACCOUNTING
+void on_screen_delete(lv_event_t *e) {
+    auto &reg = get_registry();
+    std::lock_guard l{reg.lock};
+    reg.screen_deleted(lv_event_get_target(e));
+}
+
+#endif
+
+} // namespace
+
+#ifdef LVGL_MEM_ACCOUNTING
+scope::scope(const void *ctor, lv_obj_t *parent)
+    : _prev_class{current_class}, _prev_screen{current_screen} {
+    auto &reg = get_registry();
+    std::lock_guard l{reg.lock};
+
+    current_class = reg.for_ctor(ctor);
+    if (parent) {
+        current_screen = reg.for_screen(lv_obj_get_screen(parent));
+    } else {
+        // most likely a screen; bind() decides once the object exists
+        _new_screen = reg.create(kind::screen, nullptr, {});
+        current_screen = _new_screen;
+    }
+}
+
+scope::scope(const lv_obj_t *obj)
+    : _prev_class{current_class}, _prev_screen{current_screen} {
+    auto &reg = get_registry();
+    std::lock_guard l{reg.lock};
+
+    current_class = reg.for_class(lv_obj_get_class(obj));
+    current_screen = reg.for_screen(lv_obj_get_screen(obj));
+}
+
+scope::~scope() {
+    current_class = _prev_class;
+    current_screen = _prev_screen;
+}
+
+void scope::bind(lv_obj_t *obj) {
+    auto &reg = get_registry();
+    {
+        std::lock_guard l{reg.lock};
+        reg.bind_class(current_class, lv_obj_get_class(obj));
+        if (!_new_screen)
+            return;
+
+        // LVGL picked a parent itself, e.g. the top layer for a msgbox
+        if (lv_obj_get_parent(obj)) {
+            auto scr = reg.for_screen(lv_obj_get_screen(obj));
+            _new_screen->merge_into(*scr);
+            _new_screen = nullptr;
+            current_screen = scr;
+            return;
+        }
+
+        _new_screen->name = name_of_screen(obj);
+        reg.bind_screen(_new_screen, obj);
+    }
+
+    lv_obj_add_event_cb(obj, on_screen_delete, LV_EVENT_DELETE, nullptr);
+}
+#endif
+
+void set_screen_name(lv_obj_t *scr, const char *name) {
+    auto &reg = get_registry();
+    std::lock_guard l{reg.lock};
+    reg.for_screen(scr)->name = name;
+}
+
+std::string class_name(const lv_obj_class_t *cls) { return name_of(cls); }
+
+std::size_t block_size(const void *ptr) {
+    return (static_cast<const block_header *>(ptr) - 1)->size;
+}
+
+std::size_t block_capacity(const void *ptr) {
+    return (static_cast<const block_header *>(ptr) - 1)->capacity;
+}
+
+void *reserve(void *ptr, std::size_t capacity) {
+    if (!ptr) {
+        ptr = lvgl_mem_alloc(capacity);
+        if (ptr)
+            (static_cast<block_header *>(ptr) - 1)->size = 0;
+        return ptr;
+    }
+
+    auto hdr = static_cast<block_header *>(ptr) - 1;
+    if (capacity <= hdr->capacity)
+        return ptr;
+
+    const auto size = hdr->size;
+    ptr = lvgl_mem_realloc(ptr, capacity);
+    if (ptr)
+        (static_cast<block_header *>(ptr) - 1)->size = size;
+    return ptr;
+}
+
+snapshot take_snapshot() {
+    auto &reg = get_registry();
+    std::lock_guard l{reg.lock};
+
+    snapshot s;
+    for (auto &acc : reg.accounts()) {
+        if (acc.merged.load(std::memory_order_relaxed))
+            continue;
+        auto u = acc.get_usage();
+        s._entries.push_back({acc.type, acc.name, acc.key, acc.id, acc.alive, u});
+
+        // every block is charged to exactly one class account
+        if (acc.type == kind::widget_class) {
+            s._total.bytes += u.bytes;
+            s._total.blocks += u.blocks;
+            s._total.allocs += u.allocs;
+            s._total.frees += u.frees;
+            s._total.peak_bytes += u.peak_bytes;
+        }
+    }
+
+    return s;
+}
+
+snapshot diff(const snapshot &before, const snapshot &after) {
+    snapshot d;
+
+    for (auto &e : after._entries) {
+        auto it = std::find_if(before._entries.begin(), before._entries.end(),
+                               [&](const entry &b) { return b.id == e.id; });
+
+        auto delta = e;
+        if (it != before._entries.end()) {
+            delta.use.bytes -= it->use.bytes;
+            delta.use.blocks -= it->use.blocks;
+            delta.use.allocs -= it->use.allocs;
+            delta.use.frees -= it->use.frees;
+        }
+
+        if (delta.use.bytes || delta.use.blocks || delta.use.allocs ||
+            delta.use.frees) {
+            d._entries.push_back(delta);
+        }
+    }
+
+    d._total.bytes = after._total.bytes - before._total.bytes;
+    d._total.blocks = after._total.blocks - before._total.blocks;
+    d._total.allocs = after._total.allocs - before._total.allocs;
+    d._total.frees = after._total.frees - before._total.frees;
+    d._total.peak_bytes = after._total.peak_bytes;
+
+    return d;
+}
+
+void snapshot::print(FILE *out) const {
+    auto sorted = _entries;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const entry &a, const entry &b) {
+                         if (a.type != b.type)
+                             return a.type < b.type;
+                         return a.use.bytes > b.use.bytes;
+                     });
+
+    for (auto &e : sorted) {
+        fprintf(out, "%-6s %-28s %10lld B %7lld blocks %9llu allocs "
+                     "%9llu frees %10lld B peak%s\n",
+                e.type == kind::screen ? "screen" : "class", e.name.c_str(),
+                static_cast<long long>(e.use.bytes),
+                static_cast<long long>(e.use.blocks),
+                static_cast<unsigned long long>(e.use.allocs),
+                static_cast<unsigned long long>(e.use.frees),
+                static_cast<long long>(e.use.peak_bytes),
+                e.alive ? "" : " (deleted)");
+    }
+
+    fprintf(out, "total  %-28s %10lld B %7lld blocks\n", "",
+            static_cast<long long>(_total.bytes),
+            static_cast<long long>(_total.blocks));
+}
+
+} // namespace lvgl::mem
+
+using lvgl::mem::block_header;
+
+extern "C" void *lvgl_mem_alloc(size_t size) {
+    auto hdr = static_cast<block_header *>(malloc(sizeof(block_header) + size));
+    if (!hdr)
+        return nullptr;
+
+    auto &reg = lvgl::mem::get_registry();
+    hdr->size = size;
+    hdr->capacity = size;
+    hdr->cls = lvgl::mem::current_class ? lvgl::mem::current_class
+                                        : &reg.unattributed_class;
+    hdr->scr = lvgl::mem::current_screen ? lvgl::mem::current_screen
+                                         : &reg.unattributed_screen;
+    hdr->cls->add_block(size);
+    hdr->scr->add_block(size);
+
+    return hdr + 1;
+}
+
+extern "C" void lvgl_mem_free(void *ptr) {
+    if (!ptr)
+        return;
+
+    auto hdr = static_cast<block_header *>(ptr) - 1;
+    hdr->cls->remove_block(hdr->capacity);
+    hdr->scr->owner()->remove_block(hdr->capacity);
+    free(hdr);
+}
+
+extern "C" void *lvgl_mem_realloc(void *ptr, size_t new_size) {
+    if (!ptr)
+        return lvgl_mem_alloc(new_size);
+
+    if (new_size == 0) {
+        lvgl_mem_free(ptr);
+        return nullptr;
+    }
+
+    auto old = static_cast<block_header *>(ptr) - 1;
+    // growing into reserved space keeps the block in place
+    if (new_size > old->size && new_size <= old->capacity) {
+        old->size = new_size;
+        return ptr;
+    }
+
+    const auto old_capacity = old->capacity;
+    auto hdr = static_cast<block_header *>(
+        realloc(old, sizeof(block_header) + new_size));
+    if (!hdr)
+        return nullptr;
+
+    // the block keeps its original attribution
+    const auto delta =
+        static_cast<int64_t>(new_size) - static_cast<int64_t>(old_capacity);
+    hdr->size = new_size;
+    hdr->capacity = new_size;
+    hdr->cls->resize(delta);
+    hdr->scr->owner()->resize(delta);
+
+    return hdr + 1;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+
+#if __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Allocation hooks for LV_MEM_CUSTOM_ALLOC/FREE/REALLOC. Every block is
+ * attributed to the widget class and the screen that were active when it was
+ * allocated (see lvgl_mem.hpp).
+ */
+void *lvgl_mem_alloc(size_t size);
+void lvgl_mem_free(void *ptr);
+void *lvgl_mem_realloc(void *ptr, size_t new_size);
+
+#if __cplusplus
+}
+#endif
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "lvgl.h"
+#include "lvgl_mem.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Allocation accounting for all memory LVGL requests through lv_mem_alloc().
+ *
+ * Every block carries a small header recording its size and the accounts it
+ * was charged to: one for the widget class and one for the screen. The
+ * object wrappers in lvgl.hpp open a `scope` while creating or modifying an
+ * object, everything else is charged to the "unattributed" accounts.
+ *
+ * Scopes are only compiled in when LVGL_MEM_ACCOUNTING is defined (CMake
+ * option LVGL_MEM_ACCOUNTING); otherwise they do nothing and every block is
+ * unattributed, so the totals stay exact but cost no locking.
+ */
+namespace lvgl::mem {
+
+class account;
+
+enum class kind { widget_class, screen };
+
+struct usage {
+    int64_t bytes = 0;      ///< currently allocated bytes
+    int64_t blocks = 0;     ///< currently allocated blocks
+    uint64_t allocs = 0;    ///< number of allocations ever made
+    uint64_t frees = 0;     ///< number of frees ever made
+    int64_t peak_bytes = 0; ///< maximum of `bytes`
+};
+
+struct entry {
+    kind type;
+    std::string name;
+    /// the class or screen object; screens are unique per lifetime
+    const void *key;
+    uint32_t id;
+    /// false for screens that have been deleted
+    bool alive;
+    usage use;
+};
+
+class snapshot {
+    friend snapshot take_snapshot();
+    friend snapshot diff(const snapshot &, const snapshot &);
+
+    std::vector<entry> _entries;
+    usage _total;
+
+  public:
+    const auto &entries() const { return _entries; }
+
+    const usage &total() const { return _total; }
+
+    const entry *find(kind type, const std::string &name) const {
+        for (auto &e : _entries) {
+            if (e.type == type && e.name == name)
+                return &e;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Print one line per account, largest first.
+     */
+    void print(FILE *out = stdout) const;
+};
+
+/**
+ * @brief Capture the current state of all accounts.
+ */
+snapshot take_snapshot();
+
+/**
+ * @brief Per account difference `after - before`.
+ *
+ * Accounts are matched by id, accounts created after `before` are reported
+ * with their full usage. Only entries that changed are kept, so a screen that
+ * keeps growing between two identical points of a workflow stands out.
+ */
+snapshot diff(const snapshot &before, const snapshot &after);
+
+/**
+ * @brief Give the account of screen `scr` a readable name.
+ */
+void set_screen_name(lv_obj_t *scr, const char *name);
+
+/**
+ * @brief Number of bytes requested for a block allocated through the hooks.
+ */
+std::size_t block_size(const void *ptr);
+
+/**
+ * @brief Number of bytes a block holds, including room made by reserve().
+ */
+std::size_t block_capacity(const void *ptr);
+
+/**
+ * @brief Make room for a block to grow to `capacity` bytes in place.
+ *
+ * The block keeps its size; following lv_mem_realloc() calls that grow it up
+ * to `capacity` return it unchanged. Shrinking releases the reserve. Returns
+ * the (possibly moved) block, or nullptr if out of memory, in which case the
+ * old block is still valid. A null `ptr` allocates an empty block.
+ */
+void *reserve(void *ptr, std::size_t capacity);
+
+/**
+ * @brief Name of an LVGL class as used in the reports.
+ */
+std::string class_name(const lv_obj_class_t *cls);
+
+#ifdef LVGL_MEM_ACCOUNTING
+
+/**
+ * @brief Charges allocations of the current thread to an object.
+ *
+ * Scopes nest; the previous attribution is restored on destruction.
+ */
+class scope {
+    account *_prev_class;
+    account *_prev_screen;
+    /// set while creating an object without parent, until bind() knows
+    /// whether it is a screen
+    account *_new_screen = nullptr;
+
+  public:
+    /**
+     * @brief Attribute the creation of an object.
+     *
+     * @param ctor    identifies the widget type until bind() learns its class
+     * @param parent  parent of the new object, nullptr for screens and for
+     *                objects LVGL places itself
+     */
+    scope(const void *ctor, lv_obj_t *parent);
+
+    /**
+     * @brief Attribute allocations made on behalf of an existing object.
+     */
+    explicit scope(const lv_obj_t *obj);
+
+    ~scope();
+
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+    /**
+     * @brief Tell the scope which object has been created.
+     */
+    void bind(lv_obj_t *obj);
+};
+
+#else
+
+class scope {
+  public:
+    scope(const void *, lv_obj_t *) {}
+    explicit scope(const lv_obj_t *) {}
+
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+    void bind(lv_obj_t *) {}
+};
+
+#endif
+
+} // namespace lvgl::mem
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lvgl {
+
+/**
+ * @brief Read-only mapping of a whole file.
+ *
+ * The mapping is shared: processes mapping the same file use the same pages
+ * of the page cache, and nothing is read from disk before it is touched.
+ */
+class mapped_file {
+    const uint8_t *_data = nullptr;
+    std::size_t _size = 0;
+
+  public:
+    mapped_file() = default;
+
+    explicit mapped_file(const char *path) { open(path); }
+
+    mapped_file(mapped_file &&other) noexcept
+        : _data{std::exchange(other._data, nullptr)},
+          _size{std::exchange(other._size, 0)} {}
+
+    mapped_file &operator=(mapped_file &&other) noexcept {
+        if (this != &other) {
+            close();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_file() { close(); }
+
+    bool open(const char *path) {
+        close();
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            auto p = mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                          PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                _data = static_cast<const uint8_t *>(p);
+                _size = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+        return is_open();
+    }
+
+    void close() {
+        if (_data)
+            munmap(const_cast<uint8_t *>(std::exchange(_data, nullptr)),
+                   std::exchange(_size, 0));
+    }
+
+    /**
+     * @brief Tell the kernel how the file will be read, e.g. MADV_RANDOM to
+     * only fault in touched pages instead of reading ahead.
+     */
+    void advise(int advice) const {
+        if (_data)
+            madvise(const_cast<uint8_t *>(_data), _size, advice);
+    }
+
+    bool is_open() const { return _data != nullptr; }
+
+    const uint8_t *data() const { return _data; }
+
+    std::size_t size() const { return _size; }
+};
+
+} // namespace lvgl
@@ -0,0 +1,353 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_display_driver.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Parallel refresh for display drivers.
+ *
+ * LVGL 8 keeps its draw state (masks, layer buffers, the image cache) in
+ * globals, so the rendering itself has to stay on the thread calling
+ * lv_timer_handler(). What can run concurrently is everything after it:
+ * the frame is rendered in horizontal bands into two band-sized buffers, and
+ * while LVGL renders the next band the previous one is flushed by a separate
+ * thread, which splits the conversion/copy of its rows across a
+ * work-stealing pool. Bands are flushed in render order, and the flush only
+ * reads the band buffer, so widget state is never touched off the LVGL
+ * thread.
+ */
+namespace lvgl::parallel {
+
+/**
+ * @brief Fixed set of threads executing parallel loops.
+ *
+ * Each thread owns a queue of chunks; idle threads steal from the back of the
+ * other queues, so uneven chunks (e.g. rows with a lot of anti-aliased text)
+ * even out. The calling thread takes part in every loop, a pool of size 1
+ * runs everything inline.
+ */
+class work_stealing_pool {
+    struct job {
+        void (*fn)(void *, int, int);
+        void *ctx;
+        std::atomic<int> *pending;
+        int first;
+        int last;
+    };
+
+    struct queue {
+        std::mutex mtx;
+        std::deque<job> jobs;
+    };
+
+    // queue 0 belongs to the thread calling parallel_for()
+    std::vector<std::unique_ptr<queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    int _queued = 0;
+    bool _stop = false;
+
+    bool pop(std::size_t self, job &j) {
+        {
+            auto &q = *_queues[self];
+            std::lock_guard lock{q.mtx};
+            if (!q.jobs.empty()) {
+                j = q.jobs.front();
+                q.jobs.pop_front();
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < _queues.size(); i++) {
+            auto &q = *_queues[(self + i) % _queues.size()];
+            std::lock_guard lock{q.mtx};
+            if (!q.jobs.empty()) {
+                j = q.jobs.back();
+                q.jobs.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static void execute(const job &j) {
+        j.fn(j.ctx, j.first, j.last);
+        j.pending->fetch_sub(1, std::memory_order_release);
+    }
+
+    void run(std::size_t self) {
+        for (;;) {
+            {
+                std::unique_lock lock{_mtx};
+                _cv.wait(lock, [this] { return _stop || _queued > 0; });
+                if (_stop)
+                    return;
+            }
+
+            job j;
+            while (pop(self, j)) {
+                {
+                    std::lock_guard lock{_mtx};
+                    _queued--;
+                }
+                execute(j);
+            }
+        }
+    }
+
+  public:
+    explicit work_stealing_pool(unsigned threads) {
+        if (threads == 0)
+            threads = 1;
+
+        for (unsigned i = 0; i < threads; i++)
+            _queues.push_back(std::make_unique<queue>());
+
+        _workers.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; i++)
+            _workers.emplace_back([this, i] { run(i); });
+    }
+
+    ~work_stealing_pool() {
+        {
+            std::lock_guard lock{_mtx};
+            _stop = true;
+        }
+        _cv.notify_all();
+        for (auto &w : _workers)
+            w.join();
+    }
+
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+    /**
+     * @brief Number of threads including the calling one.
+     */
+    unsigned size() const { return static_cast<unsigned>(_queues.size()); }
+
+    /**
+     * @brief Call `fn(first, last)` for chunks of at most `grain` items
+     * covering [begin, end) and return when all of them are done.
+     *
+     * Must not be called concurrently from several threads.
+     */
+    template <typename F>
+    void parallel_for(int begin, int end, int grain, F &&fn) {
+        if (begin >= end)
+            return;
+        if (grain < 1)
+            grain = 1;
+
+        if (size() == 1 || end - begin <= grain) {
+            fn(begin, end);
+            return;
+        }
+
+        using fn_t = std::remove_reference_t<F>;
+        auto call = [](void *ctx, int first, int last) {
+            (*static_cast<fn_t *>(ctx))(first, last);
+        };
+        auto ctx = const_cast<void *>(static_cast<const void *>(&fn));
+
+        const int chunks = (end - begin + grain - 1) / grain;
+        std::atomic<int> pending{chunks};
+
+        for (int c = 0; c < chunks; c++) {
+            const int first = begin + c * grain;
+            const int last = std::min(end, first + grain);
+            auto &q = *_queues[static_cast<std::size_t>(c) % _queues.size()];
+            std::lock_guard lock{q.mtx};
+            q.jobs.push_back(job{call, ctx, &pending, first, last});
+        }
+
+        {
+            std::lock_guard lock{_mtx};
+            _queued += chunks;
+        }
+        _cv.notify_all();
+
+        job j;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (pop(0, j)) {
+                {
+                    std::lock_guard lock{_mtx};
+                    _queued--;
+                }
+                execute(j);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+/**
+ * @brief Two band-sized draw buffers.
+ *
+ * LVGL renders the invalidated areas in chunks of at most `Height / Bands`
+ * rows; with two buffers the next band is rendered while the previous one is
+ * flushed.
+ */
+template <lv_coord_t Width, lv_coord_t Height, unsigned Bands>
+class band_buffer
+    : public drivers::draw_buffer<band_buffer<Width, Height, Bands>> {
+
+    static_assert(Bands > 0 && Bands <= static_cast<unsigned>(Height),
+                  "a band needs at least one row");
+
+    static constexpr lv_coord_t band_rows = (Height + Bands - 1) / Bands;
+
+    std::array<std::array<lv_color_t, Width * band_rows>, 2> _buffers;
+
+  public:
+    static constexpr int buffer_count = 2;
+    static constexpr std::size_t buffer_size = Width * band_rows;
+
+    auto width() const { return Width; }
+
+    auto height() const { return Height; }
+
+    lv_color_t *get_buffer(int idx) { return _buffers[idx].data(); }
+
+    auto get_buffer_size() const { return Width * band_rows; }
+};
+
+template <typename T>
+concept RowFlusher = requires(T &o, const lvgl::area_t &area,
+                              const lvgl::color_t *color_p, lv_coord_t y) {
+    {o.flush_rows(area, color_p, y, y)};
+};
+
+/**
+ * @brief Display driver flushing bands asynchronously and in parallel.
+ *
+ * Instead of flush_display() the driver implements
+ *
+ *     void flush_rows(const area_t &area, const color_t *color_p,
+ *                     lv_coord_t y1, lv_coord_t y2);
+ *
+ * which writes rows `y1..y2` (absolute, inclusive) of `area`; `color_p`
+ * points to the first pixel of `area`. It is called concurrently for
+ * disjoint row ranges from the pool threads. An optional `flush_frame()` is
+ * called on the flush thread after the last band of a refresh.
+ *
+ * Use with band_buffer (or any double buffer); with a single buffer the
+ * flush still runs in parallel but no longer overlaps with rendering.
+ */
+template <typename T>
+class parallel_display_driver : public drivers::display_driver<T> {
+
+    struct band {
+        lvgl::area_t area;
+        const lvgl::color_t *color_p;
+        bool last;
+    };
+
+    work_stealing_pool _pool;
+    int _grain;
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    band _pending;
+    bool _has_pending = false;
+    bool _stop = false;
+    std::thread _flush_thread;
+
+    auto &get() { return *static_cast<T *>(this); }
+
+    void flush_band(const band &b) {
+        LVGL_TRACE_SCOPE("flush_band");
+        _pool.parallel_for(
+            b.area.y1, b.area.y2 + 1, _grain, [&](int first, int last) {
+                get().flush_rows(b.area, b.color_p,
+                                 static_cast<lv_coord_t>(first),
+                                 static_cast<lv_coord_t>(last - 1));
+            });
+
+        if constexpr (requires(T &o) { o.flush_frame(); }) {
+            if (b.last)
+                get().flush_frame();
+        }
+    }
+
+    void run() {
+#ifdef LVGL_TRACE
+        trace::set_thread_name("flush");
+#endif
+        for (;;) {
+            band b;
+            {
+                std::unique_lock lock{_mtx};
+                _cv.wait(lock, [this] { return _stop || _has_pending; });
+                if (!_has_pending)
+                    return;
+                b = _pending;
+            }
+
+            flush_band(b);
+
+            {
+                std::lock_guard lock{_mtx};
+                _has_pending = false;
+            }
+            // LVGL polls the flushing flag, see lv_disp_flush_ready()
+            this->flush_ready();
+        }
+    }
+
+  public:
+    /**
+     * @param threads  threads converting a band, including the flush thread
+     * @param grain    rows per work item
+     */
+    template <typename Buffer>
+    parallel_display_driver(drivers::draw_buffer<Buffer> &buffer,
+                            unsigned threads, int grain = 8)
+        : drivers::display_driver<T>{buffer}, _pool{threads}, _grain{grain},
+          _flush_thread{[this] { run(); }} {}
+
+    ~parallel_display_driver() {
+        {
+            std::lock_guard lock{_mtx};
+            _stop = true;
+        }
+        _cv.notify_all();
+        _flush_thread.join();
+    }
+
+    parallel_display_driver(const parallel_display_driver &) = delete;
+    parallel_display_driver &
+    operator=(const parallel_display_driver &) = delete;
+
+    unsigned threads() const { return _pool.size(); }
+
+    /**
+     * @brief Hand the band to the flush thread and return immediately.
+     *
+     * LVGL does not start another flush before flush_ready(), so at most one
+     * band is pending.
+     */
+    void flush_display(const lvgl::area_t &area, lvgl::color_t *color_p) {
+        static_assert(RowFlusher<T>, "T must implement flush_rows()");
+        {
+            std::lock_guard lock{_mtx};
+            _pending = band{area, color_p, this->flush_is_last()};
+            _has_pending = true;
+        }
+        _cv.notify_one();
+    }
+};
+
+} // namespace lvgl::parallel
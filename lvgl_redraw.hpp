@@ -0,0 +1,354 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_display_driver.hpp"
+#include "lvgl_mem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Redraw statistics per object, to find widgets that invalidate or draw more
+ * than they need to.
+ *
+ * LVGL 8 does not tell who invalidated an area, so every invalidated area is
+ * charged to the innermost visible object covering it (including its extra
+ * draw size, e.g. shadows). Draw time is measured between the
+ * DRAW_MAIN_BEGIN and DRAW_POST_END events of an object, minus the time of
+ * its children. With partial draw buffers an object is drawn once per
+ * buffer it intersects, which the draw count shows.
+ *
+ * The optional heatmap on the display's sys layer tints each object by how
+ * often it was invalidated during the last window. It redraws the whole
+ * screen once per window, so turn it off when measuring draw times.
+ */
+namespace lvgl::redraw {
+
+struct entry {
+    const lv_obj_t *obj;
+    std::string name;
+    /// false for deleted objects
+    bool alive = true;
+    uint64_t invalidations = 0;
+    uint64_t invalidated_pixels = 0;
+    uint64_t draws = 0;
+    /// time spent drawing the object itself, without its children
+    uint64_t draw_ns = 0;
+    /// invalidations during the last complete window, for the heatmap
+    uint32_t heat = 0;
+    uint32_t window_invalidations = 0;
+};
+
+/**
+ * @brief Collects redraw statistics of one display while it exists.
+ */
+class monitor {
+    using clock = std::chrono::steady_clock;
+
+    struct frame {
+        std::size_t idx;
+        clock::time_point begin;
+        uint64_t children_ns;
+    };
+
+    lv_disp_t *_disp;
+    void (*_prev_rounder)(lv_disp_drv_t *, lv_area_t *);
+    lv_timer_cb_t _prev_refresh;
+    lv_timer_t *_timer;
+    lv_obj_t *_overlay = nullptr;
+    bool _ignore = false;
+    bool _refreshing = false;
+
+    std::vector<entry> _entries;
+    std::unordered_map<const lv_obj_t *, std::size_t> _index;
+    std::vector<frame> _drawing;
+
+    static std::vector<monitor *> &monitors() {
+        static std::vector<monitor *> m;
+        return m;
+    }
+
+    /**
+     * While refreshing, lv_refr_area() passes {0, 0, 0, h - 1} to the
+     * rounder to find how many rows fit the draw buffer; those are no
+     * invalidations.
+     */
+    static bool is_probe(const lv_area_t &area) {
+        return area.x1 == 0 && area.x2 == 0 && area.y1 == 0;
+    }
+
+    static void rounder(lv_disp_drv_t *drv, lv_area_t *area) {
+        for (auto m : monitors()) {
+            if (m->_disp->driver != drv)
+                continue;
+            if (!m->_ignore && !(m->_refreshing && is_probe(*area)))
+                m->attribute(*area);
+            if (m->_prev_rounder)
+                m->_prev_rounder(drv, area);
+        }
+    }
+
+    static void refresh(lv_timer_t *t) {
+        for (auto m : monitors()) {
+            if (m->_disp->refr_timer != t)
+                continue;
+            m->_refreshing = true;
+            m->_prev_refresh(t);
+            m->_refreshing = false;
+            return;
+        }
+    }
+
+    static bool covers(const lv_obj_t *obj, const lv_area_t &area) {
+        lv_area_t coords;
+        lv_obj_get_coords(obj, &coords);
+        const auto ext = _lv_obj_get_ext_draw_size(obj);
+        coords.x1 -= ext;
+        coords.y1 -= ext;
+        coords.x2 += ext;
+        coords.y2 += ext;
+        return _lv_area_is_in(&area, &coords, 0);
+    }
+
+    /// the innermost visible child of `obj` covering `area`, or `obj`
+    lv_obj_t *innermost(lv_obj_t *obj, const lv_area_t &area) const {
+        // children drawn last are on top
+        for (auto i = static_cast<int32_t>(lv_obj_get_child_cnt(obj)) - 1;
+             i >= 0; i--) {
+            auto child = lv_obj_get_child(obj, i);
+            if (child == _overlay || lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
+                continue;
+            if (covers(child, area))
+                return innermost(child, area);
+        }
+        return obj;
+    }
+
+    void attribute(const lv_area_t &area) {
+        lv_obj_t *obj = nullptr;
+        for (auto layer : {_disp->sys_layer, _disp->top_layer}) {
+            auto o = innermost(layer, area);
+            if (o != layer) {
+                obj = o;
+                break;
+            }
+        }
+        if (!obj)
+            obj = innermost(_disp->act_scr, area);
+
+        auto it = _index.find(obj);
+        if (it == _index.end())
+            it = _index.find(track(obj));
+
+        auto &e = _entries[it->second];
+        e.invalidations++;
+        e.window_invalidations++;
+        e.invalidated_pixels += lv_area_get_size(&area);
+    }
+
+    static void on_event(lv_event_t *ev) {
+        auto self = static_cast<monitor *>(lv_event_get_user_data(ev));
+        auto obj = lv_event_get_current_target(ev);
+        if (lv_event_get_target(ev) != obj)
+            return;
+
+        switch (lv_event_get_code(ev)) {
+        case LV_EVENT_DRAW_MAIN_BEGIN:
+            self->_drawing.push_back({self->_index.at(obj), clock::now(), 0});
+            break;
+        case LV_EVENT_DRAW_POST_END: {
+            if (self->_drawing.empty())
+                break;
+            const auto f = self->_drawing.back();
+            self->_drawing.pop_back();
+            const uint64_t total =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock::now() - f.begin)
+                    .count();
+            auto &e = self->_entries[f.idx];
+            e.draws++;
+            e.draw_ns += total - std::min(total, f.children_ns);
+            if (!self->_drawing.empty())
+                self->_drawing.back().children_ns += total;
+            break;
+        }
+        case LV_EVENT_DELETE: {
+            auto it = self->_index.find(obj);
+            if (it != self->_index.end()) {
+                self->_entries[it->second].alive = false;
+                self->_index.erase(it);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    const lv_obj_t *track(lv_obj_t *obj) {
+        char addr[24];
+        snprintf(addr, sizeof(addr), " %p", static_cast<void *>(obj));
+
+        _index.emplace(obj, _entries.size());
+        _entries.push_back(
+            {obj, mem::class_name(lv_obj_get_class(obj)) + addr});
+        lv_obj_add_event_cb(obj, on_event, LV_EVENT_ALL, this);
+        return obj;
+    }
+
+    void scan(lv_obj_t *obj) {
+        if (obj == _overlay)
+            return;
+        if (!_index.count(obj))
+            track(obj);
+        for (uint32_t i = 0; i < lv_obj_get_child_cnt(obj); i++)
+            scan(lv_obj_get_child(obj, i));
+    }
+
+    /// picks up objects created since the last window
+    void scan() {
+        for (uint32_t i = 0; i < _disp->screen_cnt; i++)
+            scan(_disp->screens[i]);
+        scan(_disp->top_layer);
+        scan(_disp->sys_layer);
+    }
+
+    static void on_window(lv_timer_t *t) {
+        auto self = static_cast<monitor *>(t->user_data);
+        self->scan();
+        for (auto &e : self->_entries) {
+            e.heat = e.window_invalidations;
+            e.window_invalidations = 0;
+        }
+        if (self->_overlay) {
+            self->_ignore = true;
+            lv_obj_invalidate(self->_overlay);
+            self->_ignore = false;
+        }
+    }
+
+    static void draw_heatmap(lv_event_t *ev) {
+        auto self = static_cast<monitor *>(lv_event_get_user_data(ev));
+        auto clip = lv_event_get_clip_area(ev);
+
+        for (const auto &e : self->_entries) {
+            if (!e.alive || e.heat == 0)
+                continue;
+
+            // blue for single invalidations, red for (almost) every frame
+            const auto ratio = std::min<uint32_t>(e.heat * 255 / 30, 255);
+            lv_draw_rect_dsc_t dsc;
+            lv_draw_rect_dsc_init(&dsc);
+            dsc.bg_color = lv_color_mix(lv_palette_main(LV_PALETTE_RED),
+                                        lv_palette_main(LV_PALETTE_BLUE),
+                                        static_cast<lv_opa_t>(ratio));
+            dsc.bg_opa = LV_OPA_40;
+            dsc.border_color = dsc.bg_color;
+            dsc.border_width = 1;
+            dsc.border_opa = LV_OPA_COVER;
+
+            lv_area_t coords;
+            lv_obj_get_coords(e.obj, &coords);
+            lv_draw_rect(&coords, clip, &dsc);
+        }
+    }
+
+  public:
+    /**
+     * @param window_ms  period in which new objects are picked up and the
+     *                   heatmap is updated
+     */
+    explicit monitor(drivers::display disp, uint32_t window_ms = 500)
+        : _disp{disp._disp}, _prev_rounder{_disp->driver->rounder_cb},
+          _prev_refresh{_disp->refr_timer->timer_cb},
+          _timer{lv_timer_create(on_window, window_ms, this)} {
+        monitors().push_back(this);
+        _disp->driver->rounder_cb = rounder;
+        lv_timer_set_cb(_disp->refr_timer, refresh);
+        scan();
+    }
+
+    ~monitor() {
+        show_heatmap(false);
+        lv_timer_del(_timer);
+        _disp->driver->rounder_cb = _prev_rounder;
+        lv_timer_set_cb(_disp->refr_timer, _prev_refresh);
+        std::erase(monitors(), this);
+
+        for (auto [obj, idx] : _index)
+            lv_obj_remove_event_cb(const_cast<lv_obj_t *>(obj), on_event);
+    }
+
+    monitor(const monitor &) = delete;
+    monitor &operator=(const monitor &) = delete;
+
+    /**
+     * @brief Show or hide the heatmap on the sys layer.
+     */
+    void show_heatmap(bool on) {
+        if (on == (_overlay != nullptr))
+            return;
+
+        _ignore = true;
+        if (on) {
+            _overlay = lv_obj_create(_disp->sys_layer);
+            lv_obj_remove_style_all(_overlay);
+            lv_obj_set_size(_overlay, lv_disp_get_hor_res(_disp),
+                            lv_disp_get_ver_res(_disp));
+            lv_obj_clear_flag(_overlay, LV_OBJ_FLAG_CLICKABLE);
+            lv_obj_add_event_cb(_overlay, draw_heatmap, LV_EVENT_DRAW_POST,
+                                this);
+        } else {
+            lv_obj_del(_overlay);
+            _overlay = nullptr;
+        }
+        _ignore = false;
+    }
+
+    /**
+     * @brief Forget everything counted so far.
+     */
+    void reset() {
+        for (auto &e : _entries)
+            e = {e.obj, e.name, e.alive};
+        std::erase_if(_entries, [](const entry &e) { return !e.alive; });
+        _index.clear();
+        for (std::size_t i = 0; i < _entries.size(); i++)
+            _index[_entries[i].obj] = i;
+    }
+
+    /**
+     * @brief All objects that were invalidated or drawn, most invalidated
+     * pixels first.
+     */
+    std::vector<entry> report() const {
+        std::vector<entry> r;
+        std::copy_if(_entries.begin(), _entries.end(), std::back_inserter(r),
+                     [](const entry &e) { return e.invalidations || e.draws; });
+        std::stable_sort(r.begin(), r.end(),
+                         [](const entry &a, const entry &b) {
+                             return a.invalidated_pixels > b.invalidated_pixels;
+                         });
+        return r;
+    }
+
+    /**
+     * @brief Print the report, one line per object.
+     */
+    void print(FILE *out = stdout) const {
+        fprintf(out, "%-36s %8s %12s %8s %10s\n", "object", "invals",
+                "inval px", "draws", "draw ms");
+        for (const auto &e : report()) {
+            fprintf(out, "%-36s %8llu %12llu %8llu %10.3f%s\n", e.name.c_str(),
+                    static_cast<unsigned long long>(e.invalidations),
+                    static_cast<unsigned long long>(e.invalidated_pixels),
+                    static_cast<unsigned long long>(e.draws),
+                    e.draw_ns / 1e6, e.alive ? "" : " (deleted)");
+        }
+    }
+};
+
+} // namespace lvgl::redraw
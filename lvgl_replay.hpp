@@ -0,0 +1,384 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_driver.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdio.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Input recording and deterministic replay.
+ *
+ * A `recorder` observes the reads of existing input drivers and logs every
+ * change of their state with its time. A `player` registers one input
+ * device per recorded one and hands the changes back to LVGL in order, while
+ * a `virtual_clock` is the only source of LVGL's tick. Advancing the clock in
+ * fixed steps makes LVGL's timers, animations and input reads happen at the
+ * same ticks on every run, so a replayed session renders the same frames.
+ */
+namespace lvgl::replay {
+
+enum class device_type : uint8_t { pointer, keypad, encoder };
+
+/// a change of one device's state, `time` in ms since the recording started
+struct event {
+    uint32_t time;
+    uint8_t device;
+    lv_indev_state_t state;
+    lv_coord_t x, y;
+    uint32_t key;
+    int16_t enc_diff;
+};
+
+struct recording {
+    std::vector<device_type> devices;
+    std::vector<event> events;
+
+    /// time of the last event
+    uint32_t duration() const {
+        return events.empty() ? 0 : events.back().time;
+    }
+
+    /**
+     * @brief Write the recording as text, one event per line.
+     */
+    bool save(const char *path) const {
+        auto f = fopen(path, "w");
+        if (!f)
+            return false;
+
+        static const char *const names[] = {"pointer", "keypad", "encoder"};
+        fprintf(f, "lvgl-input 1\n");
+        for (auto d : devices)
+            fprintf(f, "device %s\n", names[static_cast<int>(d)]);
+        for (const auto &e : events)
+            fprintf(f, "%u %u %d %d %d %u %d\n", e.time, e.device, e.state,
+                    e.x, e.y, e.key, e.enc_diff);
+
+        return fclose(f) == 0;
+    }
+
+    static std::optional<recording> load(const char *path) {
+        auto f = fopen(path, "r");
+        if (!f)
+            return std::nullopt;
+
+        recording rec;
+        int ver = 0;
+        bool ok = fscanf(f, "lvgl-input %d\n", &ver) == 1 && ver == 1;
+
+        char name[16];
+        while (ok && fscanf(f, "device %15s\n", name) == 1) {
+            if (!strcmp(name, "pointer"))
+                rec.devices.push_back(device_type::pointer);
+            else if (!strcmp(name, "keypad"))
+                rec.devices.push_back(device_type::keypad);
+            else if (!strcmp(name, "encoder"))
+                rec.devices.push_back(device_type::encoder);
+            else
+                ok = false;
+        }
+
+        unsigned time, device, key;
+        int state, x, y, diff;
+        while (ok && fscanf(f, "%u %u %d %d %d %u %d\n", &time, &device,
+                            &state, &x, &y, &key, &diff) == 7) {
+            ok = device < rec.devices.size();
+            rec.events.push_back({time, static_cast<uint8_t>(device),
+                                  static_cast<lv_indev_state_t>(state),
+                                  static_cast<lv_coord_t>(x),
+                                  static_cast<lv_coord_t>(y), key,
+                                  static_cast<int16_t>(diff)});
+        }
+
+        ok = ok && feof(f);
+        fclose(f);
+        if (!ok)
+            return std::nullopt;
+        return rec;
+    }
+};
+
+/**
+ * @brief Records the input of drivers derived from input_pointer_driver,
+ * input_keyboard_driver and input_encoder_driver.
+ */
+class recorder {
+    struct source {
+        recorder *self;
+        drivers::input_driver_base *drv;
+        uint8_t device;
+        std::optional<event> last;
+    };
+
+    recording _rec;
+    std::vector<std::unique_ptr<source>> _sources;
+    uint32_t _start = lv_tick_get();
+    const char *_path;
+
+    static device_type type_of(const lv_indev_drv_t &drv) {
+        switch (drv.type) {
+        case LV_INDEV_TYPE_KEYPAD:
+            return device_type::keypad;
+        case LV_INDEV_TYPE_ENCODER:
+            return device_type::encoder;
+        default:
+            return device_type::pointer;
+        }
+    }
+
+    static void observe(void *ctx, const lv_indev_drv_t &drv,
+                        const lv_indev_data_t &data) {
+        auto src = static_cast<source *>(ctx);
+        event e{};
+        e.time = lv_tick_elaps(src->self->_start);
+        e.device = src->device;
+        e.state = data.state;
+
+        switch (type_of(drv)) {
+        case device_type::pointer:
+            e.x = data.point.x;
+            e.y = data.point.y;
+            break;
+        case device_type::keypad:
+            e.key = data.key;
+            break;
+        case device_type::encoder:
+            e.enc_diff = data.enc_diff;
+            break;
+        }
+
+        // only changes are logged; encoder steps always are
+        const auto &l = src->last;
+        if (l && l->state == e.state && l->x == e.x && l->y == e.y &&
+            l->key == e.key && e.enc_diff == 0)
+            return;
+
+        src->last = e;
+        src->self->_rec.events.push_back(e);
+    }
+
+    void attach_base(drivers::input_driver_base &drv, device_type type) {
+        auto src = std::make_unique<source>(source{
+            this, &drv, static_cast<uint8_t>(_rec.devices.size()), {}});
+        _rec.devices.push_back(type);
+        drv.set_read_observer(observe, src.get());
+        _sources.push_back(std::move(src));
+    }
+
+  public:
+    /**
+     * @param path  file the recording is saved to when the recorder is
+     *              destroyed, nullptr to only keep it in memory
+     */
+    explicit recorder(const char *path = nullptr) : _path{path} {}
+
+    recorder(const recorder &) = delete;
+    recorder &operator=(const recorder &) = delete;
+
+    ~recorder() {
+        for (auto &src : _sources)
+            src->drv->set_read_observer(nullptr, nullptr);
+        if (_path)
+            _rec.save(_path);
+    }
+
+    /**
+     * @brief Record every input device `drv` implements.
+     */
+    template <typename T> void attach(T &drv) {
+        if constexpr (std::is_base_of_v<drivers::input_pointer_driver<T>, T>)
+            attach_base(static_cast<drivers::input_pointer_driver<T> &>(drv),
+                        device_type::pointer);
+        if constexpr (std::is_base_of_v<drivers::input_keyboard_driver<T>, T>)
+            attach_base(static_cast<drivers::input_keyboard_driver<T> &>(drv),
+                        device_type::keypad);
+        if constexpr (std::is_base_of_v<drivers::input_encoder_driver<T>, T>)
+            attach_base(static_cast<drivers::input_encoder_driver<T> &>(drv),
+                        device_type::encoder);
+    }
+
+    const recording &get_recording() const { return _rec; }
+};
+
+/**
+ * @brief LVGL's tick source for replays.
+ *
+ * Nothing else may call lv_tick_inc() while a clock is in use.
+ */
+class virtual_clock {
+    uint32_t _now = 0;
+
+  public:
+    /// ms advanced since the clock was created
+    uint32_t now() const { return _now; }
+
+    void advance(uint32_t ms) {
+        _now += ms;
+        lv_tick_inc(ms);
+    }
+};
+
+/**
+ * @brief Feeds a recording back to LVGL.
+ *
+ * Each device hands out the recorded changes one per read, once the clock
+ * has reached their time, and repeats its last state in between. The
+ * player has to outlive its use by LVGL, as input devices are never
+ * unregistered.
+ */
+class player {
+    class device {
+      protected:
+        const player &_player;
+        std::vector<event> _events;
+        std::size_t _next = 0;
+        event _current{};
+
+        /// advance to the next due change; true if another one is due
+        bool step() {
+            if (_next < _events.size() &&
+                _events[_next].time <= _player._clock.now())
+                _current = _events[_next++];
+            else
+                _current.enc_diff = 0;
+
+            return _next < _events.size() &&
+                   _events[_next].time <= _player._clock.now();
+        }
+
+      public:
+        device(const player &p, uint8_t idx) : _player{p} {
+            for (const auto &e : p._rec.events) {
+                if (e.device == idx)
+                    _events.push_back(e);
+            }
+        }
+
+        bool finished() const { return _next == _events.size(); }
+    };
+
+    class pointer : public device,
+                    public drivers::input_pointer_driver<pointer> {
+      public:
+        pointer(const player &p, uint8_t idx, lv_disp_t *disp)
+            : device{p, idx}, input_pointer_driver{disp} {}
+
+        void get_pointer_state(lv_coord_t &x, lv_coord_t &y,
+                               lv_indev_state_t &state) {
+            step();
+            x = _current.x;
+            y = _current.y;
+            state = _current.state;
+        }
+    };
+
+    class keypad : public device,
+                   public drivers::input_keyboard_driver<keypad> {
+      public:
+        keypad(const player &p, uint8_t idx, lv_disp_t *disp)
+            : device{p, idx}, input_keyboard_driver{disp} {}
+
+        bool get_keyboard_state(uint32_t &key, lv_indev_state_t &state) {
+            const bool more = step();
+            key = _current.key;
+            state = _current.state;
+            return more;
+        }
+    };
+
+    class encoder : public device,
+                    public drivers::input_encoder_driver<encoder> {
+      public:
+        encoder(const player &p, uint8_t idx, lv_disp_t *disp)
+            : device{p, idx}, input_encoder_driver{disp} {}
+
+        bool get_encoder_state(int16_t &diff, lv_indev_state_t &state) {
+            const bool more = step();
+            diff = _current.enc_diff;
+            state = _current.state;
+            return more;
+        }
+    };
+
+    const recording &_rec;
+    virtual_clock &_clock;
+    std::vector<std::unique_ptr<pointer>> _pointers;
+    std::vector<std::unique_ptr<keypad>> _keypads;
+    std::vector<std::unique_ptr<encoder>> _encoders;
+
+  public:
+    /**
+     * @param disp  display the devices act on, nullptr for the default one
+     */
+    player(const recording &rec, virtual_clock &clock,
+           lv_disp_t *disp = nullptr)
+        : _rec{rec}, _clock{clock} {
+        for (std::size_t i = 0; i < rec.devices.size(); i++) {
+            const auto idx = static_cast<uint8_t>(i);
+            switch (rec.devices[i]) {
+            case device_type::pointer:
+                _pointers.push_back(
+                    std::make_unique<pointer>(*this, idx, disp));
+                break;
+            case device_type::keypad:
+                _keypads.push_back(std::make_unique<keypad>(*this, idx, disp));
+                break;
+            case device_type::encoder:
+                _encoders.push_back(
+                    std::make_unique<encoder>(*this, idx, disp));
+                break;
+            }
+        }
+    }
+
+    player(const player &) = delete;
+    player &operator=(const player &) = delete;
+
+    /**
+     * @brief Keypads and encoders are added to `g` like live ones would be.
+     */
+    void set_group(const lvgl::group &g) {
+        for (auto &k : _keypads)
+            k->set_group(g);
+        for (auto &e : _encoders)
+            e->set_group(g);
+    }
+
+    /**
+     * @brief Whether every recorded change has been handed to LVGL.
+     */
+    bool finished() const {
+        auto done = [](const auto &devs) {
+            for (const auto &d : devs) {
+                if (!d->finished())
+                    return false;
+            }
+            return true;
+        };
+        return done(_pointers) && done(_keypads) && done(_encoders);
+    }
+
+    /**
+     * @brief Run LVGL in steps of `period` ms until the recording is over.
+     *
+     * @param frame  called after every lv_timer_handler()
+     */
+    template <typename F> void run(uint32_t period, F &&frame) {
+        while (!finished()) {
+            _clock.advance(period);
+            lv_timer_handler();
+            frame();
+        }
+    }
+
+    void run(uint32_t period) {
+        run(period, [] {});
+    }
+};
+
+} // namespace lvgl::replay
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LVGL_ROTATE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LVGL_ROTATE_NEON 1
+#endif
+
+/**
+ * Pixel buffer rotation for the display flush path.
+ *
+ * 90° and 270° are transposes with one of the two axes mirrored, which is
+ * expressed with a negative row stride. The transpose walks the image in
+ * tiles small enough for source and destination rows to stay in L1, and
+ * transposes 16- and 32-bit pixels in registers (8x8 resp. 4x4) where SSE2 or
+ * NEON is available.
+ *
+ * The rotation directions follow LVGL's LV_DISP_ROT_* conventions.
+ */
+namespace lvgl::rotate {
+
+namespace detail {
+
+/// tile edge in pixels, a multiple of every micro kernel size
+inline constexpr int tile = 32;
+
+template <typename P>
+inline void transpose_scalar(const P *src, std::ptrdiff_t src_stride, P *dst,
+                             std::ptrdiff_t dst_stride, int w, int h) {
+    for (int r = 0; r < w; r++) {
+        auto d = dst + r * dst_stride;
+        auto s = src + r;
+        for (int c = 0; c < h; c++)
+            d[c] = s[c * src_stride];
+    }
+}
+
+#if LVGL_ROTATE_SSE2
+
+inline void transpose_4x4(const uint32_t *src, std::ptrdiff_t src_stride,
+                          uint32_t *dst, std::ptrdiff_t dst_stride) {
+    auto load = [&](int i) {
+        return _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(src + i * src_stride));
+    };
+    const auto a = load(0), b = load(1), c = load(2), d = load(3);
+
+    const auto t0 = _mm_unpacklo_epi32(a, b);
+    const auto t1 = _mm_unpacklo_epi32(c, d);
+    const auto t2 = _mm_unpackhi_epi32(a, b);
+    const auto t3 = _mm_unpackhi_epi32(c, d);
+
+    auto store = [&](int i, __m128i v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * dst_stride), v);
+    };
+    store(0, _mm_unpacklo_epi64(t0, t1));
+    store(1, _mm_unpackhi_epi64(t0, t1));
+    store(2, _mm_unpacklo_epi64(t2, t3));
+    store(3, _mm_unpackhi_epi64(t2, t3));
+}
+
+inline void transpose_8x8(const uint16_t *src, std::ptrdiff_t src_stride,
+                          uint16_t *dst, std::ptrdiff_t dst_stride) {
+    __m128i a[8];
+    for (int i = 0; i < 8; i++)
+        a[i] = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(src + i * src_stride));
+
+    __m128i b[8];
+    for (int i = 0; i < 4; i++) {
+        b[2 * i] = _mm_unpacklo_epi16(a[2 * i], a[2 * i + 1]);
+        b[2 * i + 1] = _mm_unpackhi_epi16(a[2 * i], a[2 * i + 1]);
+    }
+
+    const __m128i c[8] = {
+        _mm_unpacklo_epi32(b[0], b[2]), _mm_unpackhi_epi32(b[0], b[2]),
+        _mm_unpacklo_epi32(b[1], b[3]), _mm_unpackhi_epi32(b[1], b[3]),
+        _mm_unpacklo_epi32(b[4], b[6]), _mm_unpackhi_epi32(b[4], b[6]),
+        _mm_unpacklo_epi32(b[5], b[7]), _mm_unpackhi_epi32(b[5], b[7]),
+    };
+
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i * dst_stride),
+                         _mm_unpacklo_epi64(c[i], c[i + 4]));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(dst + (2 * i + 1) * dst_stride),
+            _mm_unpackhi_epi64(c[i], c[i + 4]));
+    }
+}
+
+#elif LVGL_ROTATE_NEON
+
+inline void transpose_4x4(const uint32_t *src, std::ptrdiff_t src_stride,
+                          uint32_t *dst, std::ptrdiff_t dst_stride) {
+    const auto t01 = vtrnq_u32(vld1q_u32(src), vld1q_u32(src + src_stride));
+    const auto t23 = vtrnq_u32(vld1q_u32(src + 2 * src_stride),
+                               vld1q_u32(src + 3 * src_stride));
+
+    vst1q_u32(dst, vcombine_u32(vget_low_u32(t01.val[0]),
+                                vget_low_u32(t23.val[0])));
+    vst1q_u32(dst + dst_stride, vcombine_u32(vget_low_u32(t01.val[1]),
+                                             vget_low_u32(t23.val[1])));
+    vst1q_u32(dst + 2 * dst_stride, vcombine_u32(vget_high_u32(t01.val[0]),
+                                                 vget_high_u32(t23.val[0])));
+    vst1q_u32(dst + 3 * dst_stride, vcombine_u32(vget_high_u32(t01.val[1]),
+                                                 vget_high_u32(t23.val[1])));
+}
+
+inline void transpose_8x8(const uint16_t *src, std::ptrdiff_t src_stride,
+                          uint16_t *dst, std::ptrdiff_t dst_stride) {
+    auto load = [&](int i) { return vld1q_u16(src + i * src_stride); };
+    const auto t0 = vtrnq_u16(load(0), load(1));
+    const auto t1 = vtrnq_u16(load(2), load(3));
+    const auto t2 = vtrnq_u16(load(4), load(5));
+    const auto t3 = vtrnq_u16(load(6), load(7));
+
+    auto trn32 = [](uint16x8_t a, uint16x8_t b) {
+        return vtrnq_u32(vreinterpretq_u32_u16(a), vreinterpretq_u32_u16(b));
+    };
+    const auto u0 = trn32(t0.val[0], t1.val[0]);
+    const auto u1 = trn32(t0.val[1], t1.val[1]);
+    const auto u2 = trn32(t2.val[0], t3.val[0]);
+    const auto u3 = trn32(t2.val[1], t3.val[1]);
+
+    auto store = [&](int i, uint32x2_t lo, uint32x2_t hi) {
+        vst1q_u16(dst + i * dst_stride,
+                  vreinterpretq_u16_u32(vcombine_u32(lo, hi)));
+    };
+    store(0, vget_low_u32(u0.val[0]), vget_low_u32(u2.val[0]));
+    store(1, vget_low_u32(u1.val[0]), vget_low_u32(u3.val[0]));
+    store(2, vget_low_u32(u0.val[1]), vget_low_u32(u2.val[1]));
+    store(3, vget_low_u32(u1.val[1]), vget_low_u32(u3.val[1]));
+    store(4, vget_high_u32(u0.val[0]), vget_high_u32(u2.val[0]));
+    store(5, vget_high_u32(u1.val[0]), vget_high_u32(u3.val[0]));
+    store(6, vget_high_u32(u0.val[1]), vget_high_u32(u2.val[1]));
+    store(7, vget_high_u32(u1.val[1]), vget_high_u32(u3.val[1]));
+}
+
+#endif
+
+#if LVGL_ROTATE_SSE2 || LVGL_ROTATE_NEON
+inline void transpose_kernel(const uint32_t *src, std::ptrdiff_t src_stride,
+                             uint32_t *dst, std::ptrdiff_t dst_stride) {
+    transpose_4x4(src, src_stride, dst, dst_stride);
+}
+
+inline void transpose_kernel(const uint16_t *src, std::ptrdiff_t src_stride,
+                             uint16_t *dst, std::ptrdiff_t dst_stride) {
+    transpose_8x8(src, src_stride, dst, dst_stride);
+}
+
+template <typename P> inline constexpr int kernel_size = 0;
+template <> inline constexpr int kernel_size<uint32_t> = 4;
+template <> inline constexpr int kernel_size<uint16_t> = 8;
+#endif
+
+/**
+ * @brief dst(r, c) = src(c, r) for a `h` x `w` source.
+ */
+template <typename P>
+inline void transpose(const P *src, std::ptrdiff_t src_stride, P *dst,
+                      std::ptrdiff_t dst_stride, int w, int h) {
+    for (int r0 = 0; r0 < w; r0 += tile) {
+        const int tw = std::min(tile, w - r0);
+        for (int c0 = 0; c0 < h; c0 += tile) {
+            const int th = std::min(tile, h - c0);
+            const P *s = src + c0 * src_stride + r0;
+            P *d = dst + r0 * dst_stride + c0;
+
+#if LVGL_ROTATE_SSE2 || LVGL_ROTATE_NEON
+            if constexpr (kernel_size<P> > 0) {
+                constexpr int k = kernel_size<P>;
+                const int kw = tw - tw % k;
+                const int kh = th - th % k;
+                for (int r = 0; r < kw; r += k) {
+                    for (int c = 0; c < kh; c += k)
+                        transpose_kernel(s + c * src_stride + r, src_stride,
+                                         d + r * dst_stride + c, dst_stride);
+                }
+                // ragged right and bottom edges of the tile
+                transpose_scalar(s + kh * src_stride, src_stride, d + kh,
+                                 dst_stride, kw, th - kh);
+                transpose_scalar(s + kw, src_stride, d + kw * dst_stride,
+                                 dst_stride, tw - kw, th);
+                continue;
+            }
+#endif
+            transpose_scalar(s, src_stride, d, dst_stride, tw, th);
+        }
+    }
+}
+
+/// the integer type the kernels work on for pixels of type P
+template <typename P>
+using raw_t = std::conditional_t<
+    sizeof(P) == 4, uint32_t,
+    std::conditional_t<sizeof(P) == 2, uint16_t, P>>;
+
+template <typename P> inline auto raw(P *p) {
+    if constexpr (std::is_const_v<P>)
+        return reinterpret_cast<const raw_t<std::remove_const_t<P>> *>(p);
+    else
+        return reinterpret_cast<raw_t<P> *>(p);
+}
+
+} // namespace detail
+
+/**
+ * @brief Rotate a `w` x `h` image as LV_DISP_ROT_90 does.
+ *
+ * `dst` becomes `h` pixels wide and `w` rows high:
+ * dst(r, c) = src(c, w - 1 - r).
+ */
+template <typename P>
+inline void rotate_90(const P *src, int w, int h, P *dst) {
+    // transpose into dst with its rows in reverse order
+    detail::transpose(detail::raw(src), w, detail::raw(dst) + (w - 1) * h,
+                      -static_cast<std::ptrdiff_t>(h), w, h);
+}
+
+/**
+ * @brief Rotate a `w` x `h` image by 180°: dst(r, c) = src(h-1-r, w-1-c).
+ */
+template <typename P>
+inline void rotate_180(const P *src, int w, int h, P *dst) {
+    const auto n = static_cast<std::size_t>(w) * h;
+    std::reverse_copy(detail::raw(src), detail::raw(src) + n, detail::raw(dst));
+}
+
+/**
+ * @brief Rotate a `w` x `h` image as LV_DISP_ROT_270 does.
+ *
+ * `dst` becomes `h` pixels wide and `w` rows high:
+ * dst(r, c) = src(h - 1 - c, r).
+ */
+template <typename P>
+inline void rotate_270(const P *src, int w, int h, P *dst) {
+    // transpose the source read bottom-up
+    detail::transpose(detail::raw(src) + (h - 1) * w,
+                      -static_cast<std::ptrdiff_t>(w), detail::raw(dst), h, w,
+                      h);
+}
+
+} // namespace lvgl::rotate
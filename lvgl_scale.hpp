@@ -0,0 +1,270 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LVGL_SCALE_SSE2 1
+#endif
+
+/**
+ * Scaling stage between LVGL's native resolution and the panel.
+ *
+ * Integer factors (e.g. 240x136 to 480x272) replicate pixels and only touch
+ * the flushed area. Fractional factors (e.g. 480x272 to 1280x720) filter
+ * bilinearly in 8-bit fixed point: output pixels near the edge of a flushed
+ * area also depend on native pixels outside of it, so those scalers keep a
+ * native-resolution shadow copy of the frame.
+ */
+namespace lvgl::scale {
+
+class scaler {
+    static constexpr int frac_bits = 16;
+
+    /// per output column/row: left/top native pixel and the weight of its
+    /// right/bottom neighbour (0..256)
+    struct taps {
+        std::vector<int32_t> first;
+        std::vector<uint16_t> weight;
+    };
+
+    coord_t _src_w, _src_h;
+    coord_t _dst_w, _dst_h;
+    int _kx = 0, _ky = 0;
+    uint32_t _inv_x, _inv_y;
+
+    taps _tx, _ty;
+    std::vector<lv_color_t> _shadow;
+    std::vector<lv_color_t> _row;
+    std::vector<lv_color_t> _out;
+
+    static int integer_factor(coord_t src, coord_t dst) {
+        return dst >= src && dst % src == 0 ? dst / src : 0;
+    }
+
+    static uint32_t inverse(coord_t src, coord_t dst) {
+        // rounded up, so that output pixel k * dst / src maps to native k
+        return static_cast<uint32_t>(
+            ((static_cast<uint64_t>(src) << frac_bits) + dst - 1) / dst);
+    }
+
+    static taps make_taps(coord_t src, coord_t dst) {
+        taps t;
+        t.first.resize(dst);
+        t.weight.resize(dst);
+        for (coord_t o = 0; o < dst; o++) {
+            // centre of output pixel o in native coordinates, minus half a
+            // pixel to get to the left tap
+            int64_t f = ((2 * int64_t(o) + 1) * src << (frac_bits - 1)) / dst -
+                        (1 << (frac_bits - 1));
+            f = std::max<int64_t>(f, 0);
+
+            int32_t p = static_cast<int32_t>(f >> frac_bits);
+            uint16_t w = static_cast<uint16_t>((f >> (frac_bits - 8)) & 0xff);
+            // keep both taps inside the image
+            if (p >= src - 1) {
+                p = std::max(0, src - 2);
+                w = src > 1 ? 256 : 0;
+            }
+            t.first[o] = p;
+            t.weight[o] = w;
+        }
+        return t;
+    }
+
+    /// output range [first, last] whose taps touch native [n1, n2]
+    static std::pair<coord_t, coord_t> affected(const taps &t, coord_t n1,
+                                                coord_t n2) {
+        auto lo = std::lower_bound(t.first.begin(), t.first.end(), n1 - 1);
+        auto hi = std::upper_bound(t.first.begin(), t.first.end(), n2);
+        const auto dst = static_cast<coord_t>(t.first.size());
+        // when scaling down an area can fall between two output pixels;
+        // flush one anyway so the driver still signals completion
+        const auto first = std::min(static_cast<coord_t>(lo - t.first.begin()),
+                                    static_cast<coord_t>(dst - 1));
+        const auto last =
+            std::max(static_cast<coord_t>(hi - t.first.begin() - 1), first);
+        return {first, last};
+    }
+
+    static uint32_t lerp(uint32_t a, uint32_t b, uint32_t w) {
+        const uint32_t iw = 256 - w;
+        const uint32_t rb =
+            (((a & 0xff00ff) * iw + (b & 0xff00ff) * w) >> 8) & 0xff00ff;
+        const uint32_t ag =
+            (((a >> 8) & 0xff00ff) * iw + ((b >> 8) & 0xff00ff) * w) &
+            0xff00ff00;
+        return rb | ag;
+    }
+
+    static lv_color_t lerp(lv_color_t a, lv_color_t b, uint32_t w) {
+        if constexpr (sizeof(lv_color_t) == 4) {
+            lv_color_t c;
+            c.full = lerp(a.full, b.full, w);
+            return c;
+        } else {
+            // lv_color_mix() takes the weight of its first argument
+            return lv_color_mix(b, a, static_cast<uint8_t>(std::min(w, 255u)));
+        }
+    }
+
+    /// _row[i] = blend of native rows y and y + 1 at columns x1 + i
+    void blend_rows(coord_t y, uint32_t w, coord_t x1, coord_t x2) {
+        const auto a = &_shadow[y * _src_w];
+        const auto b = a + _src_w;
+        coord_t x = x1;
+        auto out = _row.data();
+
+#if LVGL_SCALE_SSE2
+        if constexpr (sizeof(lv_color_t) == 4) {
+            const auto zero = _mm_setzero_si128();
+            const auto wb = _mm_set1_epi16(static_cast<int16_t>(w));
+            const auto wa = _mm_set1_epi16(static_cast<int16_t>(256 - w));
+            auto mix = [&](__m128i pa, __m128i pb) {
+                return _mm_srli_epi16(
+                    _mm_add_epi16(_mm_mullo_epi16(pa, wa),
+                                  _mm_mullo_epi16(pb, wb)),
+                    8);
+            };
+            for (; x + 3 <= x2; x += 4, out += 4) {
+                const auto va =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+                const auto vb =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+                const auto lo = mix(_mm_unpacklo_epi8(va, zero),
+                                    _mm_unpacklo_epi8(vb, zero));
+                const auto hi = mix(_mm_unpackhi_epi8(va, zero),
+                                    _mm_unpackhi_epi8(vb, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                                 _mm_packus_epi16(lo, hi));
+            }
+        }
+#endif
+        for (; x <= x2; x++)
+            *out++ = lerp(a[x], b[x], w);
+    }
+
+    /// horizontal pass over _row, which starts at native column x1
+    void blend_columns(coord_t o1, coord_t o2, coord_t x1, lv_color_t *out) {
+        for (coord_t o = o1; o <= o2; o++) {
+            const auto p = _row.data() + (_tx.first[o] - x1);
+            const uint32_t w = _tx.weight[o];
+#if LVGL_SCALE_SSE2
+            if constexpr (sizeof(lv_color_t) == 4) {
+                // both taps in one register: lanes 0-3 left, 4-7 right
+                const auto v = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)),
+                    _mm_setzero_si128());
+                const auto wv = _mm_set_epi16(
+                    int16_t(w), int16_t(w), int16_t(w), int16_t(w),
+                    int16_t(256 - w), int16_t(256 - w), int16_t(256 - w),
+                    int16_t(256 - w));
+                auto m = _mm_mullo_epi16(v, wv);
+                m = _mm_srli_epi16(_mm_add_epi16(m, _mm_srli_si128(m, 8)), 8);
+                const auto c = _mm_packus_epi16(m, m);
+                out->full = static_cast<uint32_t>(_mm_cvtsi128_si32(c));
+                out++;
+                continue;
+            }
+#endif
+            *out++ = lerp(p[0], p[1], w);
+        }
+    }
+
+    lv_color_t *scale_nearest(lvgl::area_t &area, const lv_color_t *color_p) {
+        const auto w = area.get_width();
+        const auto h = area.get_height();
+        const auto ow = w * _kx;
+        _out.resize(static_cast<std::size_t>(ow) * h * _ky);
+
+        auto out = _out.data();
+        for (coord_t y = 0; y < h; y++, color_p += w) {
+            auto row = out;
+            for (coord_t x = 0; x < w; x++)
+                out = std::fill_n(out, _kx, color_p[x]);
+            for (int i = 1; i < _ky; i++, out += ow)
+                std::memcpy(out, row, ow * sizeof(lv_color_t));
+        }
+
+        area = {static_cast<coord_t>(area.x1 * _kx),
+                static_cast<coord_t>(area.y1 * _ky),
+                static_cast<coord_t>((area.x2 + 1) * _kx - 1),
+                static_cast<coord_t>((area.y2 + 1) * _ky - 1)};
+        return _out.data();
+    }
+
+    lv_color_t *scale_bilinear(lvgl::area_t &area, const lv_color_t *color_p) {
+        const auto w = area.get_width();
+        for (coord_t y = area.y1; y <= area.y2; y++, color_p += w)
+            std::memcpy(&_shadow[y * _src_w + area.x1], color_p,
+                        w * sizeof(lv_color_t));
+
+        const auto [ox1, ox2] = affected(_tx, area.x1, area.x2);
+        const auto [oy1, oy2] = affected(_ty, area.y1, area.y2);
+
+        // native columns read by the output range
+        const coord_t x1 = _tx.first[ox1];
+        const coord_t x2 = std::min<coord_t>(_tx.first[ox2] + 1, _src_w - 1);
+
+        const auto ow = ox2 - ox1 + 1;
+        _out.resize(static_cast<std::size_t>(ow) * (oy2 - oy1 + 1));
+        _row.resize(_src_w);
+
+        auto out = _out.data();
+        for (coord_t o = oy1; o <= oy2; o++, out += ow) {
+            blend_rows(_ty.first[o], _ty.weight[o], x1, x2);
+            blend_columns(ox1, ox2, x1, out);
+        }
+
+        area = {ox1, oy1, ox2, oy2};
+        return _out.data();
+    }
+
+  public:
+    scaler(coord_t src_w, coord_t src_h, coord_t dst_w, coord_t dst_h)
+        : _src_w{src_w}, _src_h{src_h}, _dst_w{dst_w}, _dst_h{dst_h},
+          _inv_x{inverse(src_w, dst_w)}, _inv_y{inverse(src_h, dst_h)} {
+        _kx = integer_factor(src_w, dst_w);
+        _ky = integer_factor(src_h, dst_h);
+
+        if (!is_integer()) {
+            _kx = _ky = 0;
+            _tx = make_taps(src_w, dst_w);
+            _ty = make_taps(src_h, dst_h);
+            _shadow.resize(static_cast<std::size_t>(src_w) * src_h);
+        }
+    }
+
+    bool is_integer() const { return _kx > 0 && _ky > 0; }
+
+    coord_t get_x_res() const { return _dst_w; }
+
+    coord_t get_y_res() const { return _dst_h; }
+
+    /**
+     * @brief Scale a flushed native area.
+     *
+     * `area` is replaced by the output area; the returned pixels stay valid
+     * until the next call.
+     */
+    lv_color_t *scale(lvgl::area_t &area, const lv_color_t *color_p) {
+        return is_integer() ? scale_nearest(area, color_p)
+                            : scale_bilinear(area, color_p);
+    }
+
+    /**
+     * @brief Map output (panel) coordinates to native ones.
+     */
+    void to_native(coord_t &x, coord_t &y) const {
+        x = static_cast<coord_t>(std::clamp<int64_t>(
+            (int64_t(x) * _inv_x) >> frac_bits, 0, _src_w - 1));
+        y = static_cast<coord_t>(std::clamp<int64_t>(
+            (int64_t(y) * _inv_y) >> frac_bits, 0, _src_h - 1));
+    }
+};
+
+} // namespace lvgl::scale
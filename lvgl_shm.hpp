@@ -0,0 +1,608 @@
+#pragma once
+
+#include "lvgl.hpp"
+#include "lvgl_display_driver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * Display backend publishing frames through POSIX shared memory (Linux).
+ *
+ * The UI process owns a ring of complete framebuffers in a shared memory
+ * object. Each refresh is written into a back slot that no reader holds,
+ * brought up to date with the areas changed since that slot was last
+ * written, and published together with its dirty rectangles. Other
+ * processes map the same object with a `reader`, wait on a futex for the
+ * next frame and use the pixels in place.
+ *
+ * A slot is either being written or published. Readers pin a published slot
+ * with a counter; the writer marks a slot as being written before it checks
+ * that counter, and a reader checks the mark after pinning, so the two can
+ * never use a slot at the same time. The writer never takes a pinned slot:
+ * if all of them stay pinned, the frame is rendered off the ring and
+ * published with the next one. Pins are only taken back from reader
+ * processes that no longer exist.
+ */
+namespace lvgl::shm {
+
+inline constexpr uint32_t magic = 0x4c56534d; // "LVSM"
+inline constexpr uint32_t version = 2;
+inline constexpr uint32_t max_rects = 32;
+inline constexpr uint32_t max_readers = 16;
+
+struct rect {
+    int16_t x1, y1, x2, y2;
+};
+
+/// per slot, followed by the pixels at `ring_header::pixel_offset`
+struct alignas(64) slot_header {
+    /// 1 when published, 0 while being written
+    std::atomic<uint32_t> state;
+    /// number of readers using the slot; also a futex word
+    std::atomic<uint32_t> readers;
+    uint64_t frame;
+    /// the whole frame changed, `rects` is not meaningful
+    uint32_t full;
+    uint32_t rect_count;
+    rect rects[max_rects];
+};
+
+/// a reader process, so the pins of readers that died can be released
+struct reader_entry {
+    /// 0 while unused
+    std::atomic<uint32_t> pid;
+    /// bit i is set while the reader holds slot i
+    std::atomic<uint32_t> pinned;
+};
+
+struct alignas(64) ring_header {
+    /// written last by the owner, readers check it before anything else
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    /// bytes per row
+    uint32_t stride;
+    uint32_t bits_per_pixel;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t pixel_offset;
+    /// slot of the most recent frame, `no_slot` before the first one
+    std::atomic<uint32_t> latest;
+    /// bumped for every published frame; readers wait on it
+    std::atomic<uint32_t> seq;
+    reader_entry readers[max_readers];
+};
+
+inline constexpr uint32_t no_slot = UINT32_MAX;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "futex words must be plain 32-bit integers");
+
+namespace detail {
+
+inline void futex_wait(std::atomic<uint32_t> &word, uint32_t expected,
+                       std::chrono::milliseconds timeout) {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+    timespec ts{static_cast<time_t>(ns / 1000000000),
+                static_cast<long>(ns % 1000000000)};
+    // shared futex: the word lives in memory mapped by several processes
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT,
+            expected, &ts, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<uint32_t> &word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE,
+            INT_MAX, nullptr, nullptr, 0);
+}
+
+inline constexpr std::size_t page = 4096;
+
+inline constexpr std::size_t page_align(std::size_t n) {
+    return (n + page - 1) / page * page;
+}
+
+/// shared memory object mapped read/write
+class mapping {
+    void *_base = nullptr;
+    std::size_t _size = 0;
+
+  public:
+    mapping() = default;
+    mapping(const mapping &) = delete;
+    mapping &operator=(const mapping &) = delete;
+
+    ~mapping() { reset(); }
+
+    void reset() {
+        if (_base)
+            munmap(std::exchange(_base, nullptr), _size);
+    }
+
+    bool map(int fd, std::size_t size) {
+        auto p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            return false;
+        _base = p;
+        _size = size;
+        return true;
+    }
+
+    explicit operator bool() const { return _base != nullptr; }
+
+    auto header() const { return static_cast<ring_header *>(_base); }
+
+    auto slot(uint32_t idx) const {
+        return reinterpret_cast<slot_header *>(header() + 1) + idx;
+    }
+
+    auto pixels(uint32_t idx) const {
+        const auto h = header();
+        return static_cast<uint8_t *>(_base) + h->pixel_offset +
+               std::size_t(idx) * h->slot_size;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Display driver writing into a shared memory frame ring.
+ *
+ * @tparam Slots  number of framebuffers; with one reader three keep the
+ *                writer from ever waiting
+ */
+template <lv_coord_t Hor, lv_coord_t Ver, uint32_t Slots = 3>
+class shm_display_driver : public lvgl::drivers::display_driver<
+                               shm_display_driver<Hor, Ver, Slots>> {
+
+    static_assert(Slots >= 2, "the ring needs a back slot");
+    static_assert(Slots <= 32, "reader_entry::pinned has a bit per slot");
+
+    using base =
+        lvgl::drivers::display_driver<shm_display_driver<Hor, Ver, Slots>>;
+
+    static constexpr uint32_t stride = Hor * sizeof(lv_color_t);
+    static constexpr std::size_t slot_size = detail::page_align(stride * Ver);
+    static constexpr std::size_t pixel_offset = detail::page_align(
+        sizeof(ring_header) + Slots * sizeof(slot_header));
+
+    /// how long a pinned slot is waited for before the frame is skipped
+    static constexpr std::chrono::milliseconds reader_timeout{100};
+    /// `_back` while rendering a skipped frame into `_scratch`
+    static constexpr uint32_t scratch_slot = Slots;
+
+    /// dirty areas of recent frames, to bring older slots up to date
+    struct history_entry {
+        uint64_t frame;
+        bool full;
+        std::vector<rect> rects;
+    };
+
+    const char *_name;
+    detail::mapping _map;
+    uint32_t _back = no_slot;
+    uint64_t _frame = 0;
+    std::vector<rect> _rects;
+    std::deque<history_entry> _history;
+    /// skipped frames, on top of the latest published one
+    std::vector<uint8_t> _scratch;
+    bool _skipping = false;
+    /// the next published frame has to be treated as changed everywhere
+    bool _force_full = false;
+
+    ring_header &header() { return *_map.header(); }
+
+    uint32_t pick_back_slot() {
+        const auto latest = header().latest.load(std::memory_order_relaxed);
+        uint32_t best = no_slot;
+        bool best_free = false;
+        for (uint32_t i = 0; i < Slots; i++) {
+            if (i == latest)
+                continue;
+            const auto s = _map.slot(i);
+            const bool free = s->readers.load(std::memory_order_relaxed) == 0;
+            // prefer free slots, then the oldest frame
+            if (best == no_slot || (free && !best_free) ||
+                (free == best_free && s->frame < _map.slot(best)->frame)) {
+                best = i;
+                best_free = free;
+            }
+        }
+        return best;
+    }
+
+    void copy_rect(uint32_t dst, uint32_t src, const rect &r) {
+        const auto bytes = (r.x2 - r.x1 + 1) * sizeof(lv_color_t);
+        for (int y = r.y1; y <= r.y2; y++) {
+            const auto ofs = y * stride + r.x1 * sizeof(lv_color_t);
+            std::memcpy(_map.pixels(dst) + ofs, _map.pixels(src) + ofs, bytes);
+        }
+    }
+
+    uint8_t *back_pixels() {
+        return _back == scratch_slot ? _scratch.data() : _map.pixels(_back);
+    }
+
+    /// release the pins of reader processes that no longer exist
+    void reclaim_dead_readers() {
+        for (auto &r : header().readers) {
+            const auto pid = r.pid.load(std::memory_order_acquire);
+            if (pid == 0 || kill(static_cast<pid_t>(pid), 0) == 0 ||
+                errno != ESRCH)
+                continue;
+
+            const auto bits = r.pinned.exchange(0, std::memory_order_seq_cst);
+            for (uint32_t i = 0; i < Slots; i++) {
+                if (bits & (1u << i))
+                    _map.slot(i)->readers.fetch_sub(1,
+                                                    std::memory_order_seq_cst);
+            }
+            r.pid.store(0, std::memory_order_release);
+        }
+    }
+
+    /// @return whether all readers left the slot
+    bool wait_for_readers(slot_header *s) {
+        // don't stall every frame while a reader keeps holding its slots
+        const auto timeout =
+            _skipping ? std::chrono::milliseconds{0} : reader_timeout;
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (auto n = s->readers.load(std::memory_order_seq_cst); n != 0;
+             n = s->readers.load(std::memory_order_seq_cst)) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                reclaim_dead_readers();
+                return s->readers.load(std::memory_order_seq_cst) == 0;
+            }
+            detail::futex_wait(s->readers, n, std::chrono::milliseconds{10});
+        }
+        return true;
+    }
+
+    void begin_frame() {
+        _back = pick_back_slot();
+        auto s = _map.slot(_back);
+
+        s->state.store(0, std::memory_order_seq_cst);
+        if (!wait_for_readers(s)) {
+            // a live reader still holds it, so it was published before
+            s->state.store(1, std::memory_order_seq_cst);
+            _back = scratch_slot;
+            if (!_skipping) {
+                _scratch.resize(stride * Ver);
+                const auto latest =
+                    header().latest.load(std::memory_order_relaxed);
+                if (latest != no_slot)
+                    std::memcpy(_scratch.data(), _map.pixels(latest),
+                                stride * Ver);
+                _skipping = true;
+            }
+            return;
+        }
+
+        if (_skipping) {
+            // the skipped frames are newer than anything published
+            std::memcpy(_map.pixels(_back), _scratch.data(), stride * Ver);
+            _skipping = false;
+            _force_full = true;
+            return;
+        }
+
+        // catch up on the frames published since this slot was written
+        const auto latest = header().latest.load(std::memory_order_relaxed);
+        if (latest == no_slot)
+            return;
+
+        const auto since = s->frame;
+        const bool covered = since != 0 && !_history.empty() &&
+                             _history.front().frame <= since + 1;
+        if (!covered) {
+            std::memcpy(_map.pixels(_back), _map.pixels(latest), stride * Ver);
+            return;
+        }
+        for (const auto &h : _history) {
+            if (h.frame <= since)
+                continue;
+            if (h.full) {
+                std::memcpy(_map.pixels(_back), _map.pixels(latest),
+                            stride * Ver);
+                return;
+            }
+            for (const auto &r : h.rects)
+                copy_rect(_back, latest, r);
+        }
+    }
+
+    void publish() {
+        if (_back == scratch_slot) {
+            _rects.clear();
+            _back = no_slot;
+            return;
+        }
+
+        auto s = _map.slot(_back);
+        const bool full = _force_full || _rects.size() > max_rects;
+        _force_full = false;
+
+        s->frame = ++_frame;
+        s->full = full;
+        s->rect_count = full ? 0 : static_cast<uint32_t>(_rects.size());
+        std::copy_n(_rects.begin(), s->rect_count, s->rects);
+        s->state.store(1, std::memory_order_seq_cst);
+
+        header().latest.store(_back, std::memory_order_release);
+        header().seq.fetch_add(1, std::memory_order_release);
+        detail::futex_wake(header().seq);
+
+        _history.push_back({_frame, full, std::move(_rects)});
+        if (_history.size() > 2 * Slots)
+            _history.pop_front();
+        _rects.clear();
+        _back = no_slot;
+    }
+
+  public:
+    static constexpr lv_coord_t hor_res = Hor;
+    static constexpr lv_coord_t ver_res = Ver;
+
+    /**
+     * @param name  name of the shared memory object, e.g. "/lvgl_display";
+     *              it is removed again when the driver is destroyed
+     */
+    template <typename Buffer>
+    shm_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer,
+                       const char *name)
+        : base{buffer}, _name{name} {
+        const auto size = pixel_offset + Slots * slot_size;
+
+        const int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+        if (fd < 0) {
+            LV_LOG_ERROR("cannot create shared memory object %s", name);
+            return;
+        }
+        if (ftruncate(fd, size) != 0 || !_map.map(fd, size)) {
+            LV_LOG_ERROR("cannot map shared memory object %s", name);
+            close(fd);
+            shm_unlink(name);
+            return;
+        }
+        close(fd);
+
+        // the object may be left over from an earlier run
+        auto &h = header();
+        h.magic.store(0, std::memory_order_relaxed);
+        std::memset(static_cast<void *>(h.readers), 0, sizeof(h.readers));
+        std::memset(static_cast<void *>(_map.slot(0)), 0,
+                    Slots * sizeof(slot_header));
+        h.version = version;
+        h.width = Hor;
+        h.height = Ver;
+        h.stride = stride;
+        h.bits_per_pixel = LV_COLOR_DEPTH;
+        h.slot_count = Slots;
+        h.slot_size = slot_size;
+        h.pixel_offset = pixel_offset;
+        h.latest.store(no_slot, std::memory_order_relaxed);
+        h.magic.store(magic, std::memory_order_release);
+    }
+
+    ~shm_display_driver() {
+        if (_map)
+            shm_unlink(_name);
+    }
+
+    /**
+     * @brief Whether the shared memory object could be set up; without it
+     * frames are dropped.
+     */
+    bool is_open() const { return static_cast<bool>(_map); }
+
+    void flush_display(const lvgl::area_t &area, lvgl::color_t *color_p) {
+        if (!_map) {
+            this->flush_ready();
+            return;
+        }
+
+        if (_back == no_slot)
+            begin_frame();
+
+        const auto w = area.get_width();
+        auto dst = back_pixels() + area.y1 * stride +
+                   area.x1 * sizeof(lv_color_t);
+        for (lv_coord_t y = area.y1; y <= area.y2; y++, dst += stride) {
+            std::memcpy(dst, color_p, w * sizeof(lv_color_t));
+            color_p += w;
+        }
+        _rects.push_back({area.x1, area.y1, area.x2, area.y2});
+
+        if (this->flush_is_last())
+            publish();
+
+        this->flush_ready();
+    }
+};
+
+/**
+ * @brief Consumer side of a shm_display_driver, for viewers and recorders.
+ */
+class reader {
+    detail::mapping _map;
+    uint32_t _seen = 0;
+    /// nullptr if all entries were taken; pins then can't be reclaimed
+    reader_entry *_entry = nullptr;
+
+  public:
+    /**
+     * @brief A published frame; the writer does not touch it while held.
+     *
+     * `dirty()` lists the areas changed since the previous frame. If frames
+     * were skipped (`number()` is not one more than the last one) or `full()`
+     * is set, everything has to be treated as changed.
+     */
+    class frame {
+        friend class reader;
+
+        slot_header *_slot = nullptr;
+        const uint8_t *_pixels = nullptr;
+        reader_entry *_entry;
+        uint32_t _bit;
+
+        frame(slot_header *slot, const uint8_t *pixels, reader_entry *entry,
+              uint32_t bit)
+            : _slot{slot}, _pixels{pixels}, _entry{entry}, _bit{bit} {}
+
+      public:
+        frame(const frame &) = delete;
+        frame &operator=(const frame &) = delete;
+
+        frame(frame &&other)
+            : _slot{std::exchange(other._slot, nullptr)},
+              _pixels{other._pixels}, _entry{other._entry}, _bit{other._bit} {
+        }
+
+        ~frame() {
+            if (_slot)
+                unpin(_slot, _entry, _bit);
+        }
+
+        uint64_t number() const { return _slot->frame; }
+
+        bool full() const { return _slot->full; }
+
+        std::span<const rect> dirty() const {
+            return {_slot->rects, _slot->rect_count};
+        }
+
+        /// `height()` rows of `stride()` bytes
+        const uint8_t *pixels() const { return _pixels; }
+    };
+
+  private:
+    // a reader dying between the two steps leaves the slot pinned for good
+    // rather than releasing another reader's pin
+    static void pin(slot_header *s, reader_entry *entry, uint32_t bit) {
+        s->readers.fetch_add(1, std::memory_order_seq_cst);
+        if (entry)
+            entry->pinned.fetch_or(bit, std::memory_order_seq_cst);
+    }
+
+    static void unpin(slot_header *s, reader_entry *entry, uint32_t bit) {
+        if (entry)
+            entry->pinned.fetch_and(~bit, std::memory_order_seq_cst);
+        s->readers.fetch_sub(1, std::memory_order_seq_cst);
+        detail::futex_wake(s->readers);
+    }
+
+  public:
+    /**
+     * @param name  name the UI process passed to its shm_display_driver
+     */
+    explicit reader(const char *name) {
+        const int fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 &&
+            std::size_t(st.st_size) >= sizeof(ring_header))
+            _map.map(fd, st.st_size);
+        close(fd);
+
+        if (_map && (header().magic.load(std::memory_order_acquire) != magic ||
+                     header().version != version))
+            _map.reset();
+        if (!_map)
+            return;
+
+        // lets the writer release our pins should this process die
+        const auto pid = static_cast<uint32_t>(getpid());
+        for (auto &r : _map.header()->readers) {
+            uint32_t unused = 0;
+            if (r.pid.compare_exchange_strong(unused, pid,
+                                              std::memory_order_acq_rel)) {
+                r.pinned.store(0, std::memory_order_relaxed);
+                _entry = &r;
+                break;
+            }
+        }
+    }
+
+    ~reader() {
+        if (_entry)
+            _entry->pid.store(0, std::memory_order_release);
+    }
+
+    reader(const reader &) = delete;
+    reader &operator=(const reader &) = delete;
+
+    /**
+     * @brief Whether a compatible frame ring was found.
+     */
+    bool is_open() const { return static_cast<bool>(_map); }
+
+    const ring_header &header() const { return *_map.header(); }
+
+    uint32_t width() const { return header().width; }
+
+    uint32_t height() const { return header().height; }
+
+    uint32_t stride() const { return header().stride; }
+
+    /**
+     * @brief Wait for a frame newer than the last one returned.
+     *
+     * @return  nothing if no new frame was published within `timeout`
+     */
+    std::optional<frame> wait_frame(std::chrono::milliseconds timeout) {
+        if (!_map)
+            return std::nullopt;
+
+        auto &h = *_map.header();
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        for (;;) {
+            const auto seq = h.seq.load(std::memory_order_acquire);
+            const auto idx = h.latest.load(std::memory_order_acquire);
+            if (seq != _seen && idx != no_slot) {
+                auto s = _map.slot(idx);
+                const auto bit = 1u << idx;
+                pin(s, _entry, bit);
+                if (s->state.load(std::memory_order_seq_cst) == 1) {
+                    _seen = seq;
+                    return frame{s, _map.pixels(idx), _entry, bit};
+                }
+                // the writer took the slot in the meantime
+                unpin(s, _entry, bit);
+                continue;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+                return std::nullopt;
+            detail::futex_wait(
+                h.seq, seq,
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - now));
+        }
+    }
+};
+
+} // namespace lvgl::shm
@@ -0,0 +1,192 @@
+#pragma once
+
+/**
+ * Scoped trace markers, exported as Chrome trace JSON (chrome://tracing,
+ * ui.perfetto.dev).
+ *
+ * Markers are only compiled in when LVGL_TRACE is defined (CMake option
+ * LVGL_TRACE); otherwise LVGL_TRACE_SCOPE() expands to nothing. Each thread
+ * records into its own ring buffer of the most recent `capacity` scopes
+ * without locking; write_chrome_json() can run at any time and skips records
+ * that are being overwritten while it reads them.
+ */
+
+#ifdef LVGL_TRACE
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+namespace lvgl::trace {
+
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/// ring of completed scopes, written by one thread only
+class ring {
+  public:
+    static constexpr std::size_t capacity = 1 << 14;
+
+    struct record {
+        /// index + 1 of the scope stored here, 0 while it is written
+        std::atomic<uint64_t> seq{0};
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> begin;
+        std::atomic<uint64_t> end;
+    };
+
+    const uint32_t tid;
+    std::atomic<const char *> thread_name{nullptr};
+
+    explicit ring(uint32_t id) : tid{id} {}
+
+    void push(const char *name, uint64_t begin, uint64_t end) {
+        const auto idx = _head.load(std::memory_order_relaxed);
+        auto &r = _records[idx % capacity];
+        r.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        r.name.store(name, std::memory_order_relaxed);
+        r.begin.store(begin, std::memory_order_relaxed);
+        r.end.store(end, std::memory_order_relaxed);
+        r.seq.store(idx + 1, std::memory_order_release);
+        _head.store(idx + 1, std::memory_order_release);
+    }
+
+    /// calls `fn(name, begin, end)` for each consistent record, oldest first
+    template <typename F> void for_each(F &&fn) const {
+        const auto head = _head.load(std::memory_order_acquire);
+        const auto first = head > capacity ? head - capacity : 0;
+        for (auto idx = first; idx < head; idx++) {
+            const auto &r = _records[idx % capacity];
+            if (r.seq.load(std::memory_order_acquire) != idx + 1)
+                continue;
+            const auto name = r.name.load(std::memory_order_relaxed);
+            const auto begin = r.begin.load(std::memory_order_relaxed);
+            const auto end = r.end.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (r.seq.load(std::memory_order_relaxed) == idx + 1)
+                fn(name, begin, end);
+        }
+    }
+
+  private:
+    std::atomic<uint64_t> _head{0};
+    std::array<record, capacity> _records;
+};
+
+namespace detail {
+
+/// all rings ever created; rings outlive their threads so they can be
+/// exported later
+struct registry {
+    std::mutex mtx;
+    std::vector<std::unique_ptr<ring>> rings;
+
+    static registry &get() {
+        static registry r;
+        return r;
+    }
+
+    ring &add() {
+        std::lock_guard lock{mtx};
+        rings.push_back(
+            std::make_unique<ring>(static_cast<uint32_t>(rings.size() + 1)));
+        return *rings.back();
+    }
+};
+
+inline ring &local() {
+    thread_local ring &r = registry::get().add();
+    return r;
+}
+
+} // namespace detail
+
+/**
+ * @brief Records the time between its construction and destruction.
+ *
+ * `name` must outlive the export, usually it is a string literal.
+ */
+class scope {
+    const char *_name;
+    uint64_t _begin;
+
+  public:
+    explicit scope(const char *name) : _name{name}, _begin{now_ns()} {}
+
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+    ~scope() { detail::local().push(_name, _begin, now_ns()); }
+};
+
+/**
+ * @brief Name the calling thread in exported traces.
+ */
+inline void set_thread_name(const char *name) {
+    detail::local().thread_name = name;
+}
+
+/**
+ * @brief Write the recorded scopes of all threads as Chrome trace JSON.
+ */
+inline void write_chrome_json(FILE *out) {
+    auto &reg = detail::registry::get();
+    std::lock_guard lock{reg.mtx};
+
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    auto sep = [&] {
+        fprintf(out, first ? "  " : ",\n  ");
+        first = false;
+    };
+
+    for (const auto &r : reg.rings) {
+        if (auto name = r->thread_name.load()) {
+            sep();
+            fprintf(out,
+                    "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, "
+                    "\"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+                    r->tid, name);
+        }
+        r->for_each([&](const char *name, uint64_t begin, uint64_t end) {
+            sep();
+            fprintf(out,
+                    "{\"ph\": \"X\", \"name\": \"%s\", \"pid\": 1, "
+                    "\"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                    name, r->tid, begin / 1000.0, (end - begin) / 1000.0);
+        });
+    }
+    fprintf(out, "\n]}\n");
+}
+
+inline bool write_chrome_json(const char *path) {
+    auto f = fopen(path, "w");
+    if (!f)
+        return false;
+    write_chrome_json(f);
+    return fclose(f) == 0;
+}
+
+} // namespace lvgl::trace
+
+#define LVGL_TRACE_CONCAT_(a, b) a##b
+#define LVGL_TRACE_CONCAT(a, b) LVGL_TRACE_CONCAT_(a, b)
+
+/// trace the rest of the enclosing block as `name`
+#define LVGL_TRACE_SCOPE(name)                                                 \
+    ::lvgl::trace::scope LVGL_TRACE_CONCAT(lvgl_trace_scope_, __LINE__)(name)
+
+#else
+
+#define LVGL_TRACE_SCOPE(name)
+
+#endif
@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <thread>
 #include <unistd.h>
+#include <utility>
+#include <vector>
 
 static void button_cb(lv_event_t *ev) { printf("Click\n"); }
 
@@ -76,92 +78,15 @@ void lv_example_keyboard_1(void) {
 }
 
 //#include "examples/lv_examples.h"
+#include "demo_screens.hpp"
 #include "lvgl.hpp"
 #include "lvgl_display_driver.hpp"
 #include "lvgl_driver.hpp"
-
-class my_screen : public lvgl::screen {
-  public:
-    lvgl::button btn{this};
-    lvgl::label lbl{&btn};
-    lvgl::bar bar{this};
-    lvgl::slider slider{this};
-
-    lvgl::meter meter{this};
-    lvgl::meter::scale scale{meter.add_scale()};
-    lvgl::meter::indicator indic;
-
-    lvgl::led led{this};
-    lvgl::checkbox chkbox{this};
-    lvgl::lv_switch sw{this};
-
-    my_screen() : lvgl::screen{} {
-
-        static lvgl::style btn_style;
-
-        const void *p = nullptr;
-
-        // lvgl::style::prop_value val{lv_color_black()};
-        // lvgl::style::prop_value val{1u};
-        lvgl::style::prop_value val{p};
-
-        // btn_style.set_bg_color(lv_palette_main(LV_PALETTE_RED));
-        btn_style.set_property(LV_STYLE_BG_COLOR,
-                               lv_palette_main(LV_PALETTE_RED));
-        btn.add_style(btn_style, lvgl::state::pressed);
-
-        lbl.set_text("Hello world");
-        btn.align(lvgl::alignment::center);
-        // lbl.set_pos({50, 50});
-
-        bar.set_pos(10, 10);
-        bar.set_value(50);
-
-        slider.set_pos(10, 400);
-
-        meter.set_pos(50, 50);
-        meter.set_size(200, 200);
-        meter.set_scale_ticks(scale);
-        meter.set_scale_major_ticks(scale);
-
-        auto i =
-            meter.add_indicator_arc(scale, lv_palette_main(LV_PALETTE_BLUE));
-        meter.set_indicator_start_value(i, 0);
-        meter.set_indicator_end_value(i, 20);
-
-        i = meter.add_indicator_lines(scale, lv_palette_main(LV_PALETTE_BLUE),
-                                      lv_palette_main(LV_PALETTE_BLUE), false,
-                                      0);
-        meter.set_indicator_start_value(i, 0);
-        meter.set_indicator_end_value(i, 20);
-
-        i = meter.add_indicator_arc(scale, lv_palette_main(LV_PALETTE_RED));
-        meter.set_indicator_start_value(i, 80);
-        meter.set_indicator_end_value(i, 100);
-
-        i = meter.add_indicator_lines(scale, lv_palette_main(LV_PALETTE_RED),
-                                      lv_palette_main(LV_PALETTE_RED), false,
-                                      0);
-        meter.set_indicator_start_value(i, 80);
-        meter.set_indicator_end_value(i, 100);
-
-        i = meter.add_indicator_needle(scale, 4,
-                                       lv_palette_main(LV_PALETTE_GREY), -10);
-
-        meter.set_indicator_value(i, 50);
-
-        indic = i;
-
-        led.set_pos(20, 100);
-        led.set_color(lv_palette_main(LV_PALETTE_RED));
-        led.off();
-
-        chkbox.set_text("enable foo");
-        this->chkbox.set_pos(40, 500);
-
-        sw.set_pos(40, 550);
-    }
-};
+#include "lvgl_executor.hpp"
+#include "lvgl_font.hpp"
+#include "lvgl_image.hpp"
+#include "lvgl_redraw.hpp"
+#include "lvgl_replay.hpp"
 
 #include <array>
 
@@ -234,28 +159,28 @@ class sdl_input_handler {
     sdl_input_handler() : mouse_driver{last_mouse_data} {}
 };
 
-template <lv_coord_t Hor, lv_coord_t Ver, unsigned int Zoom = 100>
-class dummy_display_driver : public lvgl::drivers::display_driver<
-                                 dummy_display_driver<Hor, Ver, Zoom>>,
-                             public lvgl::drivers::input_pointer_driver<
-                                 dummy_display_driver<Hor, Ver, Zoom>>,
-                             public lvgl::drivers::input_keyboard_driver<
-                                 dummy_display_driver<Hor, Ver, Zoom>> {
+/**
+ * SDL state shared by all simulated displays: SDL itself, the tick thread and
+ * the event pump, which hands every event to the window it belongs to.
+ */
+class sdl_context {
+  public:
+    class window {
+      public:
+        virtual uint32_t window_id() const = 0;
+        virtual void handle_event(SDL_Event &event) = 0;
+        virtual void clean_up() = 0;
 
-    struct monitor_t {
-        SDL_Window *window;
-        SDL_Renderer *renderer;
-        SDL_Texture *texture;
-        volatile bool sdl_refr_qry;
-        uint32_t *tft_fb;
+      protected:
+        ~window() = default;
     };
 
-    monitor_t monitor;
-    volatile bool sdl_quit_qry;
+  private:
+    std::vector<window *> windows;
+    volatile bool sdl_quit_qry = false;
 
     static int quit_filter(void *userdata, SDL_Event *event) {
-        auto self =
-            reinterpret_cast<dummy_display_driver<Hor, Ver, Zoom> *>(userdata);
+        auto self = reinterpret_cast<sdl_context *>(userdata);
 
         if (event->type == SDL_WINDOWEVENT) {
             if (event->window.event == SDL_WINDOWEVENT_CLOSE) {
@@ -268,38 +193,169 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
         return 1;
     }
 
-    void window_create() {
+    static int tick_thread(void *data) {
+        (void)data;
+
+        while (1) {
+            SDL_Delay(5);
+            lv_tick_inc(5); /*Tell LittelvGL that 5 milliseconds were elapsed*/
+        }
+
+        return 0;
+    }
+
+    /// 0 for events not tied to a window
+    static uint32_t event_window_id(const SDL_Event &event) {
+        switch (event.type) {
+        case SDL_WINDOWEVENT:
+            return event.window.windowID;
+        case SDL_MOUSEMOTION:
+            return event.motion.windowID;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            return event.button.windowID;
+        case SDL_MOUSEWHEEL:
+            return event.wheel.windowID;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            return event.key.windowID;
+        case SDL_TEXTINPUT:
+            return event.text.windowID;
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+            return event.tfinger.windowID;
+#endif
+        default:
+            return 0;
+        }
+    }
+
+    void event_handler() {
+        /*Refresh handling*/
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            const auto id = event_window_id(event);
+            for (auto w : windows) {
+                if (id == 0 || w->window_id() == id)
+                    w->handle_event(event);
+            }
+        }
+
+        /*Run until quit event not arrives*/
+        if (sdl_quit_qry) {
+            for (auto w : windows)
+                w->clean_up();
+            SDL_Quit();
+            exit(0);
+        }
+    }
+
+    static void event_handler(lv_timer_t *t) {
+        reinterpret_cast<sdl_context *>(t->user_data)->event_handler();
+    }
+
+    sdl_context() {
+        /*Initialize the SDL*/
+        SDL_Init(SDL_INIT_VIDEO);
+
+        SDL_SetEventFilter(quit_filter, this);
+
+        SDL_StartTextInput();
+
+        /* Tick init.
+         * You have to call 'lv_tick_inc()' in periodically to inform LittelvGL
+         * about how much time were elapsed Create an SDL thread to do this*/
+        SDL_CreateThread(tick_thread, "tick", NULL);
+
+        lv_timer_create(event_handler, 10, this);
+    }
+
+  public:
+    static sdl_context &get() {
+        static sdl_context ctx;
+        return ctx;
+    }
+
+    void add(window *w) { windows.push_back(w); }
+
+    void remove(window *w) { std::erase(windows, w); }
+};
+
+/**
+ * Unscaled windows are shown straight from LVGL's draw buffers (direct
+ * mode). Rotation needs the partial-buffer path, pass Direct = false to use
+ * it.
+ */
+template <lv_coord_t Hor, lv_coord_t Ver, unsigned int Zoom = 100,
+          bool Direct = Zoom == 100>
+class dummy_display_driver : public lvgl::drivers::display_driver<
+                                 dummy_display_driver<Hor, Ver, Zoom, Direct>>,
+                             public lvgl::drivers::input_pointer_driver<
+                                 dummy_display_driver<Hor, Ver, Zoom, Direct>>,
+                             public lvgl::drivers::input_keyboard_driver<
+                                 dummy_display_driver<Hor, Ver, Zoom, Direct>>,
+                             public sdl_context::window {
+
+    struct monitor_t {
+        SDL_Window *window;
+        SDL_Renderer *renderer;
+        SDL_Texture *texture;
+        volatile bool sdl_refr_qry;
+        uint32_t *tft_fb;
+    };
+
+    // the window shows the frame scaled by the generic flush path
+    static constexpr lv_coord_t out_hor = Hor * Zoom / 100;
+    static constexpr lv_coord_t out_ver = Ver * Zoom / 100;
+
+    // the texture is updated straight from LVGL's draw buffers
+    static constexpr bool direct = Direct;
+    static_assert(!direct || Zoom == 100, "direct mode can't scale");
+
+    monitor_t monitor;
+
+    void window_create(const char *title) {
 
         int flag = 0;
 
         monitor.window = SDL_CreateWindow(
-            "TFT Simulator", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-            Hor * Zoom / 100.0, Ver * Zoom / 100.0,
+            title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+            out_hor, out_ver,
             flag); /*last param. SDL_WINDOW_BORDERLESS to hide borders*/
 
         monitor.renderer =
             SDL_CreateRenderer(monitor.window, -1, SDL_RENDERER_SOFTWARE);
         monitor.texture =
             SDL_CreateTexture(monitor.renderer, SDL_PIXELFORMAT_ARGB8888,
-                              SDL_TEXTUREACCESS_STATIC, Hor, Ver);
+                              SDL_TEXTUREACCESS_STATIC, out_hor, out_ver);
         SDL_SetTextureBlendMode(monitor.texture, SDL_BLENDMODE_BLEND);
 
+        if constexpr (direct) {
+            // shown from the first flush on
+            monitor.tft_fb = nullptr;
+            monitor.sdl_refr_qry = false;
+            return;
+        }
+
         /*Initialize the frame buffer to gray (77 is an empirical value) */
-        monitor.tft_fb = (uint32_t *)malloc(sizeof(uint32_t) * Hor * Ver);
-        memset(monitor.tft_fb, 0x44, Hor * Ver * sizeof(uint32_t));
+        monitor.tft_fb =
+            (uint32_t *)malloc(sizeof(uint32_t) * out_hor * out_ver);
+        memset(monitor.tft_fb, 0x44, out_hor * out_ver * sizeof(uint32_t));
 
         monitor.sdl_refr_qry = true;
     }
 
     bool left_button_down;
     lv_coord_t last_x, last_y;
-    char buf[SDL_TEXTINPUTEVENT_TEXT_SIZE];
+    char buf[SDL_TEXTINPUTEVENT_TEXT_SIZE] = {};
+    bool dummy_read = false;
 
-    void monitor_sdl_clean_up() {
+    void clean_up() override {
         SDL_DestroyTexture(monitor.texture);
         SDL_DestroyRenderer(monitor.renderer);
         SDL_DestroyWindow(monitor.window);
-        SDL_Quit();
     }
 
     static uint32_t keycode_to_ctrl_key(SDL_Keycode sdl_key) {
@@ -344,6 +400,12 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
         }
     }
 
+    void set_pointer(lv_coord_t x, lv_coord_t y) {
+        this->to_native(x, y);
+        last_x = x;
+        last_y = y;
+    }
+
     void mouse_handler(SDL_Event *event) {
         switch (event->type) {
         case SDL_MOUSEBUTTONUP:
@@ -353,28 +415,23 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
         case SDL_MOUSEBUTTONDOWN:
             if (event->button.button == SDL_BUTTON_LEFT) {
                 left_button_down = true;
-                last_x = event->motion.x / (Zoom / 100.0);
-                last_y = event->motion.y / (Zoom / 100.0);
+                set_pointer(event->button.x, event->button.y);
             }
             break;
         case SDL_MOUSEMOTION:
-            last_x = event->motion.x / (Zoom / 100.0);
-            last_y = event->motion.y / (Zoom / 100.0);
+            set_pointer(event->motion.x, event->motion.y);
             break;
 
         case SDL_FINGERUP:
             left_button_down = false;
-            last_x = Hor * event->tfinger.x / (Zoom / 100.0);
-            last_y = Ver * event->tfinger.y / (Zoom / 100.0);
+            set_pointer(out_hor * event->tfinger.x, out_ver * event->tfinger.y);
             break;
         case SDL_FINGERDOWN:
             left_button_down = true;
-            last_x = Hor * event->tfinger.x / (Zoom / 100.0);
-            last_y = Ver * event->tfinger.y / (Zoom / 100.0);
+            set_pointer(out_hor * event->tfinger.x, out_ver * event->tfinger.y);
             break;
         case SDL_FINGERMOTION:
-            last_x = Hor * event->tfinger.x / (Zoom / 100.0);
-            last_y = Ver * event->tfinger.y / (Zoom / 100.0);
+            set_pointer(out_hor * event->tfinger.x, out_ver * event->tfinger.y);
             break;
         }
     }
@@ -406,91 +463,81 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
         }
     }
 
-    void sdl_event_handler() {
-        /*Refresh handling*/
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            mouse_handler(&event);
-            // mousewheel_handler(&event);
-            keyboard_handler(&event);
+    void handle_event(SDL_Event &event) override {
+        mouse_handler(&event);
+        // mousewheel_handler(&event);
+        keyboard_handler(&event);
 
-            if ((&event)->type == SDL_WINDOWEVENT) {
-                switch ((&event)->window.event) {
+        if (event.type == SDL_WINDOWEVENT) {
+            switch (event.window.event) {
 #if SDL_VERSION_ATLEAST(2, 0, 5)
-                case SDL_WINDOWEVENT_TAKE_FOCUS:
+            case SDL_WINDOWEVENT_TAKE_FOCUS:
 #endif
-                case SDL_WINDOWEVENT_EXPOSED:
-                    window_update();
-#if SDL_DUAL_DISPLAY
-                    window_update(&monitor2);
-#endif
-                    break;
-                default:
-                    break;
-                }
+            case SDL_WINDOWEVENT_EXPOSED:
+                window_update();
+                break;
+            default:
+                break;
             }
         }
-
-        /*Run until quit event not arrives*/
-        if (sdl_quit_qry) {
-            monitor_sdl_clean_up();
-            exit(0);
-        }
-    }
-
-    static void sdl_event_handler(lv_timer_t *t) {
-        (void)t;
-        auto self = reinterpret_cast<dummy_display_driver<Hor, Ver, Zoom> *>(
-            t->user_data);
-
-        self->sdl_event_handler();
     }
 
-    static int tick_thread(void *data) {
-        (void)data;
-
-        while (1) {
-            SDL_Delay(5);
-            lv_tick_inc(5); /*Tell LittelvGL that 5 milliseconds were elapsed*/
-        }
-
-        return 0;
-    }
-
-  public:
     template <typename Buffer>
-    dummy_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer)
+    dummy_display_driver(std::in_place_t,
+                         lvgl::drivers::draw_buffer<Buffer> &buffer,
+                         const char *title, lvgl::drivers::rotation rot)
         : lvgl::drivers::display_driver<
-              dummy_display_driver<Hor, Ver, Zoom>>{buffer},
+              dummy_display_driver<Hor, Ver, Zoom, Direct>>{buffer, rot},
           lvgl::drivers::input_pointer_driver<
-              dummy_display_driver<Hor, Ver, Zoom>>{} {
+              dummy_display_driver<Hor, Ver, Zoom, Direct>>{this->_disp},
+          lvgl::drivers::input_keyboard_driver<
+              dummy_display_driver<Hor, Ver, Zoom, Direct>>{this->_disp} {
 
-        /*Initialize the SDL*/
-        SDL_Init(SDL_INIT_VIDEO);
-
-        SDL_SetEventFilter(quit_filter, this);
-
-        window_create();
+        auto &sdl = sdl_context::get();
 
-        // sdl_inited = true;
+        window_create(title);
 
-        SDL_StartTextInput();
+        if constexpr (Zoom != 100)
+            this->set_scaling({out_hor, out_ver});
 
-        /* Tick init.
-         * You have to call 'lv_tick_inc()' in periodically to inform LittelvGL
-         * about how much time were elapsed Create an SDL thread to do this*/
-        SDL_CreateThread(tick_thread, "tick", NULL);
+        sdl.add(this);
+    }
 
-        lv_timer_create(sdl_event_handler, 10, this);
+  public:
+    template <typename Buffer>
+    dummy_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer,
+                         const char *title = "TFT Simulator")
+        : dummy_display_driver{std::in_place, buffer, title,
+                               lvgl::drivers::rotation::none} {}
+
+    /**
+     * @brief A rotated window; only without direct mode.
+     */
+    template <typename Buffer>
+    dummy_display_driver(lvgl::drivers::draw_buffer<Buffer> &buffer,
+                         const char *title, lvgl::drivers::rotation rot)
+        requires(!Direct)
+        : dummy_display_driver{std::in_place, buffer, title, rot} {}
+
+    ~dummy_display_driver() {
+        sdl_context::get().remove(this);
+        clean_up();
     }
 
-    auto get_x_res() const { return Hor; }
+    uint32_t window_id() const override {
+        return SDL_GetWindowID(monitor.window);
+    }
 
-    auto get_y_res() const { return Ver; }
+    static constexpr lv_coord_t hor_res = Hor;
+    static constexpr lv_coord_t ver_res = Ver;
+    static constexpr bool direct_mode = direct;
 
     void window_update() {
+        if (!monitor.tft_fb)
+            return;
+
         SDL_UpdateTexture(monitor.texture, NULL, monitor.tft_fb,
-                          Hor * sizeof(uint32_t));
+                          out_hor * sizeof(uint32_t));
 
         SDL_RenderClear(monitor.renderer);
 
@@ -511,8 +558,8 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
 
     void flush_display(const lvgl::area_t &area, lvgl::color_t *color_p) {
 
-        lv_coord_t hres = Hor;
-        lv_coord_t vres = Ver;
+        lv_coord_t hres = out_hor;
+        lv_coord_t vres = out_ver;
 
         /*Return if the area is out the screen*/
         if (area.x2 < 0 || area.y2 < 0 || area.x1 > hres - 1 ||
@@ -523,10 +570,21 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
             return;
         }
 
+        if constexpr (direct) {
+            // color_p is the whole frame, already complete on the last flush
+            if (this->flush_is_last()) {
+                monitor.tft_fb = reinterpret_cast<uint32_t *>(color_p);
+                monitor.sdl_refr_qry = true;
+                monitor_sdl_refr(NULL);
+            }
+            this->flush_ready();
+            return;
+        }
+
         int32_t y;
         uint32_t w = area.get_width();
-        for (y = area.y1; y <= area.y2 && y < Ver; y++) {
-            memcpy(&monitor.tft_fb[y * Hor + area.x1], color_p,
+        for (y = area.y1; y <= area.y2 && y < out_ver; y++) {
+            memcpy(&monitor.tft_fb[y * out_hor + area.x1], color_p,
                    w * sizeof(lv_color_t));
             color_p += w;
         }
@@ -553,7 +611,6 @@ class dummy_display_driver : public lvgl::drivers::display_driver<
     }
 
     bool get_keyboard_state(uint32_t &key, lv_indev_state_t &state) {
-        static bool dummy_read = false;
         const size_t len = strlen(buf);
 
         /*Send a release manually*/
@@ -684,56 +741,6 @@ struct S {
 };
 #endif
 
-class demo_screen : public lvgl::screen, public lvgl::event_handler {
-  public:
-    lvgl::button btn{this};
-    lvgl::label lbl{&btn};
-
-    lvgl::checkbox chkbox{this};
-    lvgl::lv_switch sw{this};
-    lvgl::spinbox sb{this};
-
-    lvgl::group grp;
-
-    demo_screen() : lvgl::screen{} {
-
-        static lvgl::style btn_style;
-
-        const void *p = nullptr;
-
-        grp.add_object(sb);
-        grp.add_object(btn);
-
-        // lvgl::style::prop_value val{lv_color_black()};
-        // lvgl::style::prop_value val{1u};
-        lvgl::style::prop_value val{p};
-
-        // btn_style.set_bg_color(lv_palette_main(LV_PALETTE_RED));
-        btn_style.set_property(LV_STYLE_BG_COLOR,
-                               lv_palette_main(LV_PALETTE_RED));
-        btn.add_style(btn_style, lvgl::state::pressed);
-
-        lbl.set_text("Hello world");
-        btn.align(lvgl::alignment::center);
-
-        chkbox.set_text("enable foo");
-        this->chkbox.set_pos(40, 500);
-
-        sw.set_pos(40, 550);
-
-        // btn.add_click_handler(this);
-        btn.add_event_handler(this, lvgl::event::LV_EVENT_CLICKED);
-    }
-
-    void on_event(object &sender, lvgl::event ev) override {
-        printf("event %d\n", static_cast<int>(ev));
-        if (sender == btn) {
-            printf("button click\n");
-            lbl.set_text("click");
-        }
-    }
-};
-
 int main() {
 
     // lv_init();
@@ -741,13 +748,25 @@ int main() {
 
     lvgl::init();
 
-    lvgl::drivers::static_buffer<800, 600> disp_buffer;
+    // direct mode: both buffers hold whole frames and are shown in turn
+    static lvgl::drivers::static_buffer<800, 600, 2> disp_buffer;
     dummy_display_driver<800, 600> disp_driver{disp_buffer};
 
     auto disp = disp_driver.get_display();
 
+    const lv_font_t *font = LV_FONT_DEFAULT;
+
+    // LVGL_FONT=<file> uses a font converted with lv_font_conv --format bin
+    if (auto path = getenv("LVGL_FONT")) {
+        static lvgl::binary_font file_font{path};
+        if (file_font.is_open()) {
+            file_font.set_fallback(LV_FONT_DEFAULT);
+            font = file_font;
+        }
+    }
+
     lvgl::theme theme{lv_palette_main(LV_PALETTE_BLUE),
-                      lv_palette_main(LV_PALETTE_RED), false, LV_FONT_DEFAULT};
+                      lv_palette_main(LV_PALETTE_RED), false, font};
 
     disp.apply_theme(theme);
 
@@ -759,6 +778,50 @@ int main() {
 
     lvgl::screen::load(scr, lvgl::screen::load_anim::none, 1000);
 
+#ifdef LVGL_IMAGE_DIR
+    // converted at build time by lvgl_add_images(), drawn from the mapping
+    static lvgl::image_file cursor_file{LVGL_IMAGE_DIR
+                                        "/mouse_cursor_icon.lvimg"};
+    lvgl::image cursor{&scr};
+    cursor.set_src(cursor_file);
+    cursor.align(lvgl::alignment::top_right, {-4, 4});
+#endif
+
+    // LVGL_RECORD=<file> saves the session's input on exit, for replays
+    static lvgl::replay::recorder input_recorder{getenv("LVGL_RECORD")};
+    if (getenv("LVGL_RECORD"))
+        input_recorder.attach(disp_driver);
+
+    // LVGL_REDRAW_STATS=1 shows the invalidation heatmap and prints the
+    // redraw statistics on exit
+    static auto redraw_stats =
+        getenv("LVGL_REDRAW_STATS") ? new lvgl::redraw::monitor{disp} : nullptr;
+    if (redraw_stats) {
+        redraw_stats->show_heatmap(true);
+        std::atexit([] { redraw_stats->print(); });
+    }
+
+    // status panel with its own buffer, theme and a slower refresh
+    lvgl::drivers::static_buffer<320, 80> status_buffer;
+    dummy_display_driver<320, 80> status_driver{status_buffer, "Status"};
+
+    auto status = status_driver.get_display();
+    status.set_refresh_period(100);
+
+    lvgl::style status_style;
+    status_style.set_bg_color(lv_palette_darken(LV_PALETTE_GREY, 4));
+    status_style.set_property(LV_STYLE_TEXT_COLOR, lv_color_white());
+    lvgl::theme status_theme{theme, status_style};
+    status.apply_theme(status_theme);
+
+    status.set_default();
+    lvgl::screen status_scr;
+    lvgl::label status_lbl{&status_scr};
+    status_lbl.set_text("ready");
+    status_lbl.align(lvgl::alignment::center);
+    lvgl::screen::load(status_scr);
+    disp.set_default();
+
 #if 0
     {
         auto top = disp.get_top_layer();
@@ -791,11 +854,27 @@ int main() {
     //}
 #endif
 
+#ifdef LVGL_TRACE
+    // LVGL_TRACE_FILE=<file> saves the trace on exit
+    lvgl::trace::set_thread_name("ui");
+    std::atexit([] {
+        if (auto path = getenv("LVGL_TRACE_FILE"))
+            lvgl::trace::write_chrome_json(path);
+    });
+#endif
+
     while (1) {
         /* Periodically call the lv_task handler.
          * It could be done in a timer interrupt or an OS task
          * too.*/
-        lv_timer_handler();
+        {
+            LVGL_TRACE_SCOPE("ui_queue");
+            lvgl::ui_queue::drain();
+        }
+        {
+            LVGL_TRACE_SCOPE("lv_timer_handler");
+            lv_timer_handler();
+        }
         usleep(5 * 1000);
     }
 }
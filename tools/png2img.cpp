@@ -0,0 +1,143 @@
+#include "lvgl_image_format.hpp"
+#include <png.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/*
+ * Converts a PNG into the native image format of lvgl_image_format.hpp, so
+ * the device maps it instead of decoding it.
+ *
+ *   png2img [--depth 8|16|32] [--swap16] [--rle] input.png output.lvimg
+ *
+ * --depth and --swap16 have to match LV_COLOR_DEPTH and LV_COLOR_16_SWAP of
+ * the firmware; the loader rejects images converted for another format.
+ * Alpha is only stored if the PNG has translucent pixels.
+ */
+
+namespace fmt = lvgl::image_format;
+
+static void usage() {
+    fprintf(stderr, "usage: png2img [--depth 8|16|32] [--swap16] [--rle] "
+                    "input.png output.lvimg\n");
+    exit(2);
+}
+
+/// append one RGBA pixel in LVGL's lv_color_t layout for `depth`
+static void put_pixel(std::vector<uint8_t> &out, const uint8_t *rgba,
+                      int depth, bool swap16, bool alpha) {
+    const uint8_t r = rgba[0], g = rgba[1], b = rgba[2], a = rgba[3];
+    switch (depth) {
+    case 32:
+        // lv_color32_t: blue, green, red, alpha
+        out.insert(out.end(), {b, g, r, alpha ? a : uint8_t(0xff)});
+        return;
+    case 16: {
+        const uint16_t c = uint16_t((r >> 3) << 11 | (g >> 2) << 5 | b >> 3);
+        if (swap16)
+            out.insert(out.end(), {uint8_t(c >> 8), uint8_t(c)});
+        else
+            out.insert(out.end(), {uint8_t(c), uint8_t(c >> 8)});
+        break;
+    }
+    default:
+        out.push_back(uint8_t((r >> 5) << 5 | (g >> 5) << 2 | b >> 6));
+        break;
+    }
+    if (alpha)
+        out.push_back(a);
+}
+
+int main(int argc, char **argv) {
+    int depth = 32;
+    bool swap16 = false;
+    bool rle = false;
+    const char *files[2] = {};
+    int nfiles = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--depth") && i + 1 < argc)
+            depth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--swap16"))
+            swap16 = true;
+        else if (!strcmp(argv[i], "--rle"))
+            rle = true;
+        else if (argv[i][0] != '-' && nfiles < 2)
+            files[nfiles++] = argv[i];
+        else
+            usage();
+    }
+    if (nfiles != 2 || (depth != 8 && depth != 16 && depth != 32))
+        usage();
+
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&png, files[0])) {
+        fprintf(stderr, "%s: %s\n", files[0], png.message);
+        return 1;
+    }
+    // lv_img_header_t stores 11 bit sizes
+    if (png.width > 2047 || png.height > 2047) {
+        fprintf(stderr, "%s: images are limited to 2047x2047\n", files[0]);
+        return 1;
+    }
+
+    png.format = PNG_FORMAT_RGBA;
+    std::vector<uint8_t> rgba(PNG_IMAGE_SIZE(png));
+    if (!png_image_finish_read(&png, nullptr, rgba.data(), 0, nullptr)) {
+        fprintf(stderr, "%s: %s\n", files[0], png.message);
+        return 1;
+    }
+
+    const std::size_t count = std::size_t(png.width) * png.height;
+    bool alpha = false;
+    for (std::size_t i = 0; i < count && !alpha; i++)
+        alpha = rgba[i * 4 + 3] != 0xff;
+
+    std::vector<uint8_t> pixels;
+    const auto px_size = fmt::pixel_size(uint8_t(depth), alpha);
+    pixels.reserve(count * px_size);
+    for (std::size_t i = 0; i < count; i++)
+        put_pixel(pixels, &rgba[i * 4], depth, swap16, alpha);
+
+    std::vector<uint8_t> stored = pixels;
+    if (rle) {
+        stored = fmt::rle_encode(pixels.data(), count, px_size);
+        // not worth decoding at runtime
+        if (stored.size() >= pixels.size()) {
+            stored = pixels;
+            rle = false;
+        }
+    }
+
+    fmt::header h{};
+    memcpy(h.magic, fmt::magic, sizeof(h.magic));
+    h.version = fmt::version;
+    h.color_depth = uint8_t(depth);
+    h.flags = uint8_t((alpha ? fmt::has_alpha : 0) | (rle ? fmt::rle : 0) |
+                      (depth == 16 && swap16 ? fmt::swap16 : 0));
+    h.width = uint16_t(png.width);
+    h.height = uint16_t(png.height);
+    h.data_size = uint32_t(pixels.size());
+    h.stored_size = uint32_t(stored.size());
+    // pixels follow the header directly, which keeps them aligned
+    h.data_offset = sizeof(h);
+    static_assert(sizeof(h) % fmt::data_alignment == 0);
+
+    auto out = fopen(files[1], "wb");
+    if (!out) {
+        perror(files[1]);
+        return 1;
+    }
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1 &&
+              fwrite(stored.data(), 1, stored.size(), out) == stored.size();
+    ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        perror(files[1]);
+        remove(files[1]);
+        return 1;
+    }
+    return 0;
+}